@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * Time Curve::GetPositionAt on curves of increasing size.
+ *
+ * The same flight plan is sampled with steps from 1e-2 to 1e-5, so that the curve grows from about
+ * 1e2 to 1e5 points, and the curve is queried at random distances along its length. As the lookup
+ * is a binary search, the time per query should grow with the logarithm of the number of points.
+ */
+#include <ns3/command-line.h>
+#include <ns3/curve.h>
+#include <ns3/flight-plan.h>
+#include <ns3/integer.h>
+#include <ns3/nstime.h>
+#include <ns3/proto-point.h>
+#include <ns3/vector.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Build a flight plan that turns several times, so that the curve is not a straight line.
+ *
+ * \return the flight plan.
+ */
+static FlightPlan
+GetFlightPlan()
+{
+    const std::vector<Vector> positions = {{0.0, 0.0, 10.0},
+                                           {200.0, 50.0, 30.0},
+                                           {400.0, 300.0, 60.0},
+                                           {150.0, 500.0, 40.0},
+                                           {-100.0, 250.0, 20.0},
+                                           {0.0, 0.0, 10.0}};
+    FlightPlan flightPlan;
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const bool isDestination = (i == 0 || i + 1 == positions.size());
+        flightPlan.Add(CreateObjectWithAttributes<ProtoPoint>("Position",
+                                                              VectorValue(positions[i]),
+                                                              "Interest",
+                                                              IntegerValue(isDestination ? 0 : 1),
+                                                              "RestTime",
+                                                              TimeValue(Seconds(0))));
+    }
+
+    return flightPlan;
+}
+
+int
+main(int argc, char** argv)
+{
+    uint32_t nQueries = 1000000;
+    uint32_t seed = 1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("queries", "Number of queries per curve", nQueries);
+    cmd.AddValue("seed", "Seed of the random distances", seed);
+    cmd.Parse(argc, argv);
+
+    const FlightPlan flightPlan = GetFlightPlan();
+    double firstNsPerQuery = 0.0;
+    double firstLog2N = 0.0;
+    double checksum = 0.0; // keeps the queries from being optimized away
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(10) << "points" << std::setw(14) << "ns/query" << std::setw(12)
+              << "ratio" << std::setw(14) << "log2 ratio" << std::endl;
+
+    for (const float step : {1e-2f, 1e-3f, 1e-4f, 1e-5f})
+    {
+        Curve curve{flightPlan, step};
+        const double length = curve.Generate();
+        const size_t n = curve.GetN();
+
+        std::mt19937 generator{seed};
+        std::uniform_real_distribution<double> distanceDistribution{0.0, length};
+        std::vector<double> distances(nQueries);
+        for (auto& d : distances)
+            d = distanceDistribution(generator);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const double d : distances)
+        {
+            const Vector p = curve.GetPositionAt(d);
+            checksum += p.x + p.y + p.z;
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const double nsPerQuery =
+            std::chrono::duration<double, std::nano>(end - start).count() / nQueries;
+        const double log2N = std::log2(static_cast<double>(n));
+        if (firstNsPerQuery == 0.0)
+        {
+            firstNsPerQuery = nsPerQuery;
+            firstLog2N = log2N;
+        }
+
+        std::cout << std::setw(10) << n << std::setw(14) << nsPerQuery << std::setw(12)
+                  << nsPerQuery / firstNsPerQuery << std::setw(14) << log2N / firstLog2N
+                  << std::endl;
+    }
+
+    std::cout << "checksum: " << checksum << std::endl;
+
+    return 0;
+}
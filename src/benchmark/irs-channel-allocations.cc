@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * Count the heap allocations made by IrsAssistedSpectrumChannel::StartTx.
+ *
+ * A transmission is started towards a set of receivers, either all within range or all beyond
+ * range, and the allocations made by StartTx are counted by replacing the global operator new.
+ * Allocations whose size matches the values of the PSD are reported apart, as copies of the
+ * SpectrumValue. The difference between the two cases is the cost of delivering a signal.
+ */
+#include <ns3/channel-condition-model.h>
+#include <ns3/command-line.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/double.h>
+#include <ns3/irs-assisted-spectrum-channel.h>
+#include <ns3/mobility-model.h>
+#include <ns3/net-device.h>
+#include <ns3/pointer.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+namespace
+{
+
+std::atomic<uint64_t> g_allocations{0};   ///< Allocations counted so far
+std::atomic<uint64_t> g_psdAllocations{0}; ///< Allocations of the size of the PSD values
+std::atomic<std::size_t> g_psdBytes{0};    ///< Size of the PSD values, zero if not counted
+std::atomic<bool> g_counting{false};       ///< Whether allocations are being counted
+
+} // namespace
+
+void*
+operator new(std::size_t size)
+{
+    if (g_counting)
+    {
+        ++g_allocations;
+        if (size == g_psdBytes)
+            ++g_psdAllocations;
+    }
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace ns3
+{
+
+/**
+ * A receiver that discards the signals it is given.
+ */
+class BenchmarkSpectrumPhy : public SpectrumPhy
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::BenchmarkSpectrumPhy")
+                                .SetParent<SpectrumPhy>()
+                                .AddConstructor<BenchmarkSpectrumPhy>();
+        return tid;
+    }
+
+    void SetDevice(Ptr<NetDevice> d) override
+    {
+        m_device = d;
+    }
+
+    Ptr<NetDevice> GetDevice() const override
+    {
+        return m_device;
+    }
+
+    void SetMobility(Ptr<MobilityModel> m) override
+    {
+        m_mobility = m;
+    }
+
+    Ptr<MobilityModel> GetMobility() const override
+    {
+        return m_mobility;
+    }
+
+    void SetChannel(Ptr<SpectrumChannel>) override
+    {
+    }
+
+    void SetRxSpectrumModel(Ptr<const SpectrumModel> model)
+    {
+        m_model = model;
+    }
+
+    Ptr<const SpectrumModel> GetRxSpectrumModel() const override
+    {
+        return m_model;
+    }
+
+    Ptr<Object> GetAntenna() const override
+    {
+        return nullptr;
+    }
+
+    void StartRx(Ptr<SpectrumSignalParameters>) override
+    {
+    }
+
+  private:
+    Ptr<NetDevice> m_device;
+    Ptr<MobilityModel> m_mobility;
+    Ptr<const SpectrumModel> m_model;
+};
+
+} // namespace ns3
+
+using namespace ns3;
+
+/**
+ * Start a transmission towards a set of receivers and count the allocations of StartTx.
+ *
+ * \param nReceivers number of receivers.
+ * \param nBands number of bands of the spectrum model.
+ * \param maxLossDb the MaxLossDb attribute of the channel.
+ * \param psdAllocations filled with the allocations of the size of the PSD values.
+ * \return the allocations made by StartTx.
+ */
+static uint64_t
+CountStartTxAllocations(uint32_t nReceivers,
+                        uint32_t nBands,
+                        double maxLossDb,
+                        uint64_t& psdAllocations)
+{
+    std::vector<double> frequencies;
+    for (uint32_t i = 0; i < nBands; ++i)
+        frequencies.push_back(2.4e9 + i * 15e3);
+    Ptr<SpectrumModel> model = Create<SpectrumModel>(frequencies);
+
+    auto channel = CreateObject<IrsAssistedSpectrumChannel>();
+    channel->SetAttribute("MaxLossDb", DoubleValue(maxLossDb));
+    channel->SetAttribute("ChannelConditionModel",
+                          PointerValue(CreateObject<AlwaysLosChannelConditionModel>()));
+
+    for (uint32_t i = 0; i < nReceivers; ++i)
+    {
+        auto mobility = CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(Vector(10. + i % 100, 10. + i / 100, 1.5));
+        auto phy = CreateObject<BenchmarkSpectrumPhy>();
+        phy->SetMobility(mobility);
+        phy->SetRxSpectrumModel(model);
+        channel->AddRx(phy);
+    }
+
+    auto txMobility = CreateObject<ConstantPositionMobilityModel>();
+    txMobility->SetPosition(Vector(0., 0., 30.));
+    auto txPhy = CreateObject<BenchmarkSpectrumPhy>();
+    txPhy->SetMobility(txMobility);
+    txPhy->SetRxSpectrumModel(model);
+
+    auto txParams = Create<SpectrumSignalParameters>();
+    txParams->duration = MilliSeconds(1);
+    txParams->txPhy = txPhy;
+    txParams->psd = Create<SpectrumValue>(model);
+    *txParams->psd = 1e-9;
+
+    // A first transmission fills the caches of the channel, which are not the object of the count
+    channel->StartTx(txParams);
+    Simulator::Run();
+
+    g_allocations = 0;
+    g_psdAllocations = 0;
+    g_psdBytes = nBands * sizeof(double);
+    g_counting = true;
+    channel->StartTx(txParams);
+    g_counting = false;
+    g_psdBytes = 0;
+    Simulator::Run();
+    Simulator::Destroy();
+
+    psdAllocations = g_psdAllocations;
+    return g_allocations;
+}
+
+int
+main(int argc, char** argv)
+{
+    uint32_t nReceivers = 1000;
+    uint32_t nBands = 1013; // An unusual number of bands, to spot the allocations of PSD values
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("receivers", "Number of receivers", nReceivers);
+    cmd.AddValue("bands", "Number of bands of the spectrum model", nBands);
+    cmd.Parse(argc, argv);
+
+    uint64_t inRangePsd = 0;
+    uint64_t beyondRangePsd = 0;
+    const auto inRange = CountStartTxAllocations(nReceivers, nBands, 1e9, inRangePsd);
+    const auto beyondRange = CountStartTxAllocations(nReceivers, nBands, 0., beyondRangePsd);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "StartTx towards " << nReceivers << " receivers" << std::endl;
+    std::cout << "  within range: " << inRange << " allocations ("
+              << static_cast<double>(inRange) / nReceivers << " per receiver), " << inRangePsd
+              << " PSD copies (" << static_cast<double>(inRangePsd) / nReceivers
+              << " per receiver)" << std::endl;
+    std::cout << "  beyond range: " << beyondRange << " allocations ("
+              << static_cast<double>(beyondRange) / nReceivers << " per receiver), "
+              << beyondRangePsd << " PSD copies ("
+              << static_cast<double>(beyondRangePsd) / nReceivers << " per receiver)"
+              << std::endl;
+    std::cout << "  delivery of a signal: "
+              << (static_cast<double>(inRange) - static_cast<double>(beyondRange)) / nReceivers
+              << " allocations" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "rem-output.h"
+
+#include <ns3/abort.h>
+#include <ns3/log.h>
+
+#include <cstring>
+#include <iomanip>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RemOutput");
+
+// Number of digits reserved in the PLY header for the number of vertices
+constexpr int PLY_COUNT_DIGITS = 20;
+
+static_assert(sizeof(RemGridHeader) % sizeof(float) == 0,
+              "REM grid values must be aligned in the file");
+
+constexpr char RemGridHeader::MAGIC[8];
+constexpr char RemGridHeader::SNAPSHOTS_MAGIC[8];
+constexpr uint32_t RemGridHeader::VERSION;
+
+uint64_t
+RemGridHeader::GetN() const
+{
+    return static_cast<uint64_t>(xRes) * yRes * zRes;
+}
+
+RemGridWriter::RemGridWriter()
+    : m_expected{0},
+      m_written{0}
+{
+}
+
+void
+RemGridWriter::Open(const std::string& path, RemGridHeader header)
+{
+    NS_LOG_FUNCTION(this << path);
+
+    std::memcpy(header.magic, RemGridHeader::MAGIC, sizeof(header.magic));
+    header.version = RemGridHeader::VERSION;
+    header.headerSize = sizeof(RemGridHeader);
+    header.reserved = 0;
+
+    m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Can't open file " << path);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_expected = header.GetN();
+    m_written = 0;
+}
+
+void
+RemGridWriter::Write(const float* values, const std::size_t n)
+{
+    NS_ASSERT_MSG(m_written + n <= m_expected, "Too many values for the REM grid");
+    m_file.write(reinterpret_cast<const char*>(values), n * sizeof(float));
+    m_written += n;
+}
+
+void
+RemGridWriter::Close()
+{
+    NS_LOG_FUNCTION(this);
+
+    NS_ABORT_MSG_IF(m_written != m_expected,
+                    "REM grid is incomplete: " << m_written << " of " << m_expected
+                                               << " values have been written");
+    m_file.close();
+}
+
+bool
+RemGridWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+void
+RemSnapshotWriter::Open(const std::string& path, RemGridHeader header)
+{
+    NS_LOG_FUNCTION(this << path);
+
+    std::memcpy(header.magic, RemGridHeader::SNAPSHOTS_MAGIC, sizeof(header.magic));
+    header.version = RemGridHeader::VERSION;
+    header.headerSize = sizeof(RemGridHeader);
+    header.reserved = 0;
+
+    m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Can't open file " << path);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    NS_ABORT_MSG_IF(header.GetN() > std::numeric_limits<uint32_t>::max(),
+                    "REM grid is too large for snapshots");
+    m_previous.assign(header.GetN(), 0.f);
+}
+
+uint64_t
+RemSnapshotWriter::Write(const double time, const std::vector<float>& values)
+{
+    NS_LOG_FUNCTION(this << time);
+    NS_ASSERT_MSG(values.size() == m_previous.size(), "Snapshot does not match the REM grid");
+
+    m_delta.clear();
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (values[i] != m_previous[i])
+        {
+            m_delta.push_back({static_cast<uint32_t>(i), values[i]});
+            m_previous[i] = values[i];
+        }
+    }
+
+    const RemSnapshotHeader frame{time, m_delta.size()};
+    m_file.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+    m_file.write(reinterpret_cast<const char*>(m_delta.data()),
+                 m_delta.size() * sizeof(RemSnapshotChange));
+    return m_delta.size();
+}
+
+void
+RemSnapshotWriter::Close()
+{
+    NS_LOG_FUNCTION(this);
+    m_file.close();
+    m_previous.clear();
+    m_delta.clear();
+}
+
+bool
+RemSnapshotWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+RemGridReader::RemGridReader(const std::string& path)
+    : m_data{nullptr},
+      m_size{0}
+{
+    NS_LOG_FUNCTION(this << path);
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    NS_ABORT_MSG_IF(fd < 0, "Can't open file " << path);
+
+    struct stat st;
+    NS_ABORT_MSG_IF(fstat(fd, &st) != 0, "Can't stat file " << path);
+    m_size = st.st_size;
+    NS_ABORT_MSG_IF(m_size < sizeof(RemGridHeader), path << " is not a REM grid");
+
+    m_data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    NS_ABORT_MSG_IF(m_data == MAP_FAILED, "Can't map file " << path);
+
+    const auto& header = GetHeader();
+    NS_ABORT_MSG_IF(std::memcmp(header.magic, RemGridHeader::MAGIC, sizeof(header.magic)) != 0 ||
+                        header.version != RemGridHeader::VERSION,
+                    path << " is not a supported REM grid");
+    NS_ABORT_MSG_IF(header.headerSize + header.GetN() * sizeof(float) > m_size,
+                    path << " is truncated");
+}
+
+RemGridReader::~RemGridReader()
+{
+    munmap(m_data, m_size);
+}
+
+const RemGridHeader&
+RemGridReader::GetHeader() const
+{
+    return *static_cast<const RemGridHeader*>(m_data);
+}
+
+const float*
+RemGridReader::GetValues() const
+{
+    return reinterpret_cast<const float*>(static_cast<const char*>(m_data) +
+                                          GetHeader().headerSize);
+}
+
+RemPlyWriter::RemPlyWriter()
+    : m_count{0}
+{
+}
+
+void
+RemPlyWriter::Open(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+
+    m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Can't open file " << path);
+
+    m_file << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex ";
+    // The number of vertices is padded with spaces, so that Close can overwrite it in place
+    m_countPos = m_file.tellp();
+    m_file << std::setw(PLY_COUNT_DIGITS) << std::left << 0 << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n"
+           << "property float intensity\n"
+           << "end_header\n";
+    m_count = 0;
+}
+
+void
+RemPlyWriter::Write(const float x, const float y, const float z, const float intensity)
+{
+    const float vertex[4] = {x, y, z, intensity};
+    m_file.write(reinterpret_cast<const char*>(vertex), sizeof(vertex));
+    ++m_count;
+}
+
+void
+RemPlyWriter::Close()
+{
+    NS_LOG_FUNCTION(this << m_count);
+
+    m_file.seekp(m_countPos);
+    m_file << std::setw(PLY_COUNT_DIGITS) << std::left << m_count;
+    m_file.close();
+}
+
+bool
+RemPlyWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+void
+RemPlyWriter::ConvertText(const std::string& txtPath, const std::string& plyPath)
+{
+    NS_LOG_FUNCTION(txtPath << plyPath);
+
+    std::ifstream txt(txtPath);
+    NS_ABORT_MSG_IF(!txt.is_open(), "Can't open file " << txtPath);
+
+    RemPlyWriter ply;
+    ply.Open(plyPath);
+    float x, y, z, sinr;
+    while (txt >> x >> y >> z >> sinr)
+        ply.Write(x, y, z, sinr);
+    ply.Close();
+}
+
+} // namespace ns3
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef REM_OUTPUT_H
+#define REM_OUTPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup helper
+ *
+ * \brief Header of a binary REM grid file.
+ *
+ * The file is made of this header, stored as is in little-endian byte order, followed by
+ * xRes * yRes * zRes float32 values of linear SINR. The value of the point (ix, iy, iz), located
+ * at (xMin + ix * xStep, yMin + iy * yStep, zMin + iz * zStep), is at index
+ * (iz * xRes + ix) * yRes + iy. Values are stored at offset headerSize, which is a multiple of
+ * the size of a value, so that the file can be memory-mapped and read as an array in place.
+ */
+struct RemGridHeader
+{
+    char magic[8];       //!< File signature, i.e., MAGIC
+    uint32_t version;    //!< Version of the format, i.e., VERSION
+    uint32_t headerSize; //!< Offset of the values from the beginning of the file
+    uint32_t xRes;       //!< Number of points along the X axis
+    uint32_t yRes;       //!< Number of points along the Y axis
+    uint32_t zRes;       //!< Number of points along the Z axis
+    uint32_t reserved;   //!< Reserved, set to zero
+    double xMin;         //!< X coordinate of the first point
+    double xMax;         //!< X coordinate of the last point
+    double yMin;         //!< Y coordinate of the first point
+    double yMax;         //!< Y coordinate of the last point
+    double zMin;         //!< Z coordinate of the first point
+    double zMax;         //!< Z coordinate of the last point
+
+    /// Signature of a grid file
+    static constexpr char MAGIC[8] = {'I', 'O', 'D', 'S', 'R', 'E', 'M', '\0'};
+    /// Signature of a snapshots file, see RemSnapshotHeader
+    static constexpr char SNAPSHOTS_MAGIC[8] = {'I', 'O', 'D', 'S', 'R', 'E', 'M', 'S'};
+    /// Version of the formats
+    static constexpr uint32_t VERSION = 1;
+
+    /** \returns the number of values of the grid. */
+    uint64_t GetN() const;
+};
+
+/**
+ * \ingroup helper
+ *
+ * \brief Stream the values of a REM grid to a binary file, in the order of their index.
+ */
+class RemGridWriter
+{
+  public:
+    RemGridWriter();
+
+    /**
+     * \brief Create the file and write its header.
+     *
+     * \param path path of the file.
+     * \param header the header of the grid. Signature, version and size are filled in.
+     */
+    void Open(const std::string& path, RemGridHeader header);
+
+    /**
+     * \brief Append values to the grid.
+     *
+     * \param values the values, in the order of their index.
+     * \param n the number of values.
+     */
+    void Write(const float* values, const std::size_t n);
+
+    /**
+     * \brief Close the file, checking that the whole grid has been written.
+     */
+    void Close();
+
+    /** \returns whether the file is open. */
+    bool IsOpen() const;
+
+  private:
+    std::ofstream m_file; ///< Output file
+    uint64_t m_expected;  ///< Number of values of the grid
+    uint64_t m_written;   ///< Number of values written so far
+};
+
+/**
+ * \ingroup helper
+ *
+ * \brief Header of a frame of a REM snapshots file.
+ *
+ * A snapshots file starts with a RemGridHeader, whose signature is SNAPSHOTS_MAGIC, followed by
+ * the frames. Each frame is this header followed by nChanges RemSnapshotChange entries, i.e., the
+ * values of the grid that changed since the previous frame. The first frame is relative to a grid
+ * of zeros.
+ */
+struct RemSnapshotHeader
+{
+    double time;       //!< Simulation time of the snapshot, in seconds
+    uint64_t nChanges; //!< Number of values that changed since the previous frame
+};
+
+/**
+ * \ingroup helper
+ *
+ * \brief A value of the grid that changed since the previous frame.
+ */
+struct RemSnapshotChange
+{
+    uint32_t index; //!< Index of the point, as described by RemGridHeader
+    float value;    //!< New linear SINR of the point
+};
+
+/**
+ * \ingroup helper
+ *
+ * \brief Stream snapshots of a REM grid to a binary file, as deltas against the previous one.
+ */
+class RemSnapshotWriter
+{
+  public:
+    /**
+     * \brief Create the file and write its header.
+     *
+     * \param path path of the file.
+     * \param header the header of the grid. Signature, version and size are filled in.
+     */
+    void Open(const std::string& path, RemGridHeader header);
+
+    /**
+     * \brief Append a snapshot.
+     *
+     * \param time simulation time of the snapshot, in seconds.
+     * \param values the whole grid, indexed as described by RemGridHeader.
+     * \returns the number of values that changed since the previous snapshot.
+     */
+    uint64_t Write(const double time, const std::vector<float>& values);
+
+    /**
+     * \brief Close the file.
+     */
+    void Close();
+
+    /** \returns whether the file is open. */
+    bool IsOpen() const;
+
+  private:
+    std::ofstream m_file;                   ///< Output file
+    std::vector<float> m_previous;          ///< Values of the previous snapshot
+    std::vector<RemSnapshotChange> m_delta; ///< Changes of the current snapshot
+};
+
+/**
+ * \ingroup helper
+ *
+ * \brief Read-only memory mapping of a binary REM grid file.
+ */
+class RemGridReader
+{
+  public:
+    /**
+     * \brief Map a file, aborting the simulation if it is not a valid REM grid.
+     *
+     * \param path path of the file.
+     */
+    RemGridReader(const std::string& path);
+    ~RemGridReader();
+
+    RemGridReader(const RemGridReader&) = delete;
+    RemGridReader& operator=(const RemGridReader&) = delete;
+
+    /** \returns the header of the grid. */
+    const RemGridHeader& GetHeader() const;
+
+    /** \returns the values of the grid, indexed as described by RemGridHeader. */
+    const float* GetValues() const;
+
+  private:
+    void* m_data;       ///< Mapped file
+    std::size_t m_size; ///< Size of the mapped file
+};
+
+/**
+ * \ingroup helper
+ *
+ * \brief Stream REM points to a binary little-endian PLY file, with the same vertex properties
+ * (x, y, z and intensity) of the files produced by analysis/txt2ply.py.
+ */
+class RemPlyWriter
+{
+  public:
+    RemPlyWriter();
+
+    /**
+     * \brief Create the file and write its header. The number of vertices is filled in by Close.
+     *
+     * \param path path of the file.
+     */
+    void Open(const std::string& path);
+
+    /**
+     * \brief Append a point.
+     *
+     * \param x X coordinate.
+     * \param y Y coordinate.
+     * \param z Z coordinate.
+     * \param intensity value of the point.
+     */
+    void Write(const float x, const float y, const float z, const float intensity);
+
+    /**
+     * \brief Write the number of vertices in the header and close the file.
+     */
+    void Close();
+
+    /** \returns whether the file is open. */
+    bool IsOpen() const;
+
+    /**
+     * \brief Convert a tab-separated text REM, with one x, y, z, SINR line per point, to PLY.
+     *
+     * \param txtPath path of the text file.
+     * \param plyPath path of the PLY file.
+     */
+    static void ConvertText(const std::string& txtPath, const std::string& plyPath);
+
+  private:
+    std::ofstream m_file;      ///< Output file
+    std::streampos m_countPos; ///< Position of the number of vertices in the header
+    uint64_t m_count;          ///< Number of vertices written so far
+};
+
+} // namespace ns3
+
+#endif /* REM_OUTPUT_H */
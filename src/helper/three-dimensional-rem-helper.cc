@@ -21,25 +21,47 @@
 #include "three-dimensional-rem-helper.h"
 
 #include <ns3/abort.h>
+#include <ns3/angles.h>
+#include <ns3/antenna-model.h>
 #include <ns3/boolean.h>
 #include <ns3/buildings-helper.h>
 #include <ns3/config.h>
 #include <ns3/constant-position-mobility-model.h>
 #include <ns3/double.h>
+#include <ns3/enum.h>
 #include <ns3/integer.h>
+#include <ns3/irs-assisted-spectrum-channel.h>
+#include <ns3/irs-list.h>
+#include <ns3/irs.h>
 #include <ns3/log.h>
+#include <ns3/lte-spectrum-signal-parameters.h>
 #include <ns3/lte-spectrum-value-helper.h>
 #include <ns3/mobility-building-info.h>
 #include <ns3/node.h>
+#include <ns3/nstime.h>
+#include <ns3/phased-array-spectrum-propagation-loss-model.h>
 #include <ns3/pointer.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/rem-output.h>
 #include <ns3/rem-spectrum-phy.h>
 #include <ns3/simulator.h>
 #include <ns3/spectrum-channel.h>
+#include <ns3/spectrum-converter.h>
+#include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/string.h>
 #include <ns3/uinteger.h>
+#include <ns3/worker-pool.h>
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 namespace ns3
 {
@@ -48,10 +70,69 @@ NS_LOG_COMPONENT_DEFINE("ThreeDimensionalRemHelper");
 
 NS_OBJECT_ENSURE_REGISTERED(ThreeDimensionalRemHelper);
 
+namespace
+{
+
+/**
+ * \return the resident memory of the process in bytes, or zero if it cannot be measured.
+ */
+uint64_t
+GetResidentMemory()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (statm >> size >> resident)
+        return resident * sysconf(_SC_PAGESIZE);
+#endif
+    return 0;
+}
+
+/**
+ * \param model a propagation or channel condition model, or nullptr.
+ * \return whether the model is one of the 3GPP models, which cache their outcome per pair of
+ * nodes.
+ */
+bool
+IsThreeGppModel(Ptr<const Object> model)
+{
+    if (!model)
+        return false;
+
+    const auto tid = model->GetInstanceTypeId();
+    for (const auto name : {"ns3::ThreeGppChannelConditionModel",
+                            "ns3::ThreeGppPropagationLossModel",
+                            "ns3::ThreeGppSpectrumPropagationLossModel"})
+    {
+        TypeId base;
+        if (TypeId::LookupByNameFailSafe(name, &base) && (tid == base || tid.IsChildOf(base)))
+            return true;
+    }
+
+    return false;
+}
+
+} // namespace
+
+ThreeDimensionalRemHelper::ThreeDimensionalRemHelper()
+    : m_snapshot{0},
+      m_evaluatedPoints{0},
+      m_done{false},
+      m_listenerPoolMemory{0}
+{
+}
+
 void
 ThreeDimensionalRemHelper::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    m_txs.clear();
+    m_contributions.clear();
+    m_propagationLoss = nullptr;
+    m_spectrumLoss = nullptr;
+    m_irsChannel = nullptr;
+    m_probe = nullptr;
 }
 
 TypeId
@@ -81,10 +162,26 @@ ThreeDimensionalRemHelper::GetTypeId()
                 MakeStringAccessor(&ThreeDimensionalRemHelper::m_channelPath),
                 MakeStringChecker())
             .AddAttribute("OutputFile",
-                          "the filename to which the Radio Environment Map is saved",
+                          "the filename to which the Radio Environment Map is saved as text. "
+                          "If empty, the text output is disabled.",
                           StringValue("rem.out"),
                           MakeStringAccessor(&ThreeDimensionalRemHelper::m_outputFile),
                           MakeStringChecker())
+            .AddAttribute("GridOutputFile",
+                          "the filename to which the whole grid of the Radio Environment Map is "
+                          "saved in the binary format described by RemGridHeader, including the "
+                          "points below the threshold. If empty, the grid output is disabled. "
+                          "It is ignored by adaptive refinement.",
+                          StringValue(""),
+                          MakeStringAccessor(&ThreeDimensionalRemHelper::m_gridOutputFile),
+                          MakeStringChecker())
+            .AddAttribute("PlyOutputFile",
+                          "the filename to which the points of the Radio Environment Map above the "
+                          "threshold are saved as a binary PLY point cloud. If empty, the PLY "
+                          "output is disabled.",
+                          StringValue(""),
+                          MakeStringAccessor(&ThreeDimensionalRemHelper::m_plyOutputFile),
+                          MakeStringChecker())
             .AddAttribute("XMin",
                           "The min x coordinate of the map.",
                           DoubleValue(0.0),
@@ -150,7 +247,8 @@ ThreeDimensionalRemHelper::GetTypeId()
                           MakeDoubleChecker<double>())
             .AddAttribute("PointsPerIteration",
                           "Number of REM points to be calculated per iteration. Every point "
-                          "consumes approximately 5KB of memory.",
+                          "consumes approximately 5KB of memory, the actual amount is reported "
+                          "when the listeners are allocated.",
                           UintegerValue(20000),
                           MakeUintegerAccessor(&ThreeDimensionalRemHelper::m_pointsPerIteration),
                           MakeUintegerChecker<uint32_t>(1, std::numeric_limits<uint32_t>::max()))
@@ -177,7 +275,78 @@ ThreeDimensionalRemHelper::GetTypeId()
                           "default value is -1, what means REM will be averaged from all RBs",
                           IntegerValue(-1),
                           MakeIntegerAccessor(&ThreeDimensionalRemHelper::m_rbId),
-                          MakeIntegerChecker<int32_t>());
+                          MakeIntegerChecker<int32_t>())
+            .AddAttribute("Engine",
+                          "LISTENERS moves RemSpectrumPhy listeners through the map in simulated "
+                          "time. DIRECT observes the transmitters for one subframe and then "
+                          "evaluates the link budget of every point, without listeners",
+                          EnumValue(RemEngineType::LISTENERS),
+                          MakeEnumAccessor<RemEngineType>(&ThreeDimensionalRemHelper::m_engine),
+                          MakeEnumChecker<RemEngineType>(RemEngineType::LISTENERS,
+                                                         "LISTENERS",
+                                                         RemEngineType::DIRECT,
+                                                         "DIRECT"))
+            .AddAttribute("Threads",
+                          "Number of threads used by the DIRECT engine. Models that are not "
+                          "known to be thread-safe are always evaluated by a single thread",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&ThreeDimensionalRemHelper::m_nThreads),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Signals",
+                          "Transmissions the DIRECT engine computes the map for. LTE_DL only "
+                          "considers the LTE downlink control or data frames, according to "
+                          "UseDataChannel, measured over Earfcn and Bandwidth. ALL considers any "
+                          "transmission on the channel, e.g., Wi-Fi or 3GPP, measured over its own "
+                          "spectrum, in which case RbId is ignored",
+                          EnumValue(RemSignalType::LTE_DL_SIGNALS),
+                          MakeEnumAccessor<RemSignalType>(&ThreeDimensionalRemHelper::m_signals),
+                          MakeEnumChecker<RemSignalType>(RemSignalType::LTE_DL_SIGNALS,
+                                                         "LTE_DL",
+                                                         RemSignalType::ALL_SIGNALS,
+                                                         "ALL"))
+            .AddAttribute("AdaptiveLevels",
+                          "Number of times the cells of the XRes x YRes x ZRes grid can be halved "
+                          "along each axis where the SINR is not uniform. The map is then a sparse "
+                          "set of points. Zero disables the refinement. Only supported by the "
+                          "DIRECT engine",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&ThreeDimensionalRemHelper::m_adaptiveLevels),
+                          MakeUintegerChecker<uint32_t>(0, 16))
+            .AddAttribute("AdaptiveTolerance",
+                          "Maximum SINR variation, in dB, among the corners of a cell that is not "
+                          "refined. Cells crossing the threshold are always refined",
+                          DoubleValue(3.0),
+                          MakeDoubleAccessor(&ThreeDimensionalRemHelper::m_adaptiveTolerance),
+                          MakeDoubleChecker<double>(0.))
+            .AddAttribute("Snapshots",
+                          "Number of maps generated by the DIRECT engine, spaced by "
+                          "SnapshotInterval in simulated time. With more than one, the power "
+                          "received from each transmitter in every point is cached, taking "
+                          "8 bytes per point and transmitter, and only recomputed when the "
+                          "transmitter moves",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&ThreeDimensionalRemHelper::m_snapshots),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("SnapshotInterval",
+                          "Simulated time between consecutive snapshots",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&ThreeDimensionalRemHelper::m_snapshotInterval),
+                          MakeTimeChecker(Time(0)))
+            .AddAttribute("SnapshotTolerance",
+                          "Distance, in meters, a transmitter has to move before its contribution "
+                          "to the snapshots is recomputed. Contributions are also recomputed when "
+                          "an IRS, or a node served by its patches, moves by this distance.",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&ThreeDimensionalRemHelper::m_snapshotTolerance),
+                          MakeDoubleChecker<double>(0.))
+            .AddAttribute("SnapshotOutputFile",
+                          "the filename to which the snapshots are saved, each as the points that "
+                          "changed since the previous one, in the format described by "
+                          "RemSnapshotHeader. The first snapshot is also saved to the other "
+                          "outputs. If empty, the snapshots output is disabled.",
+                          StringValue(""),
+                          MakeStringAccessor(&ThreeDimensionalRemHelper::m_snapshotOutputFile),
+                          MakeStringChecker());
     return tid;
 }
 
@@ -234,13 +403,60 @@ ThreeDimensionalRemHelper::Install()
                         "object at " << m_channelPath << " is not of type SpectrumChannel");
     }
 
-    m_outFile.open(m_outputFile.c_str());
-    if (!m_outFile.is_open())
+    NS_ABORT_MSG_IF(m_adaptiveLevels > 0 && m_engine != RemEngineType::DIRECT,
+                    "Adaptive refinement is only supported by the DIRECT engine.");
+    NS_ABORT_MSG_IF(m_signals != RemSignalType::LTE_DL_SIGNALS &&
+                        m_engine != RemEngineType::DIRECT,
+                    "Signals other than the LTE downlink are only supported by the DIRECT "
+                    "engine.");
+    NS_ABORT_MSG_IF(m_snapshots > 1 && m_engine != RemEngineType::DIRECT,
+                    "Snapshots are only supported by the DIRECT engine.");
+    NS_ABORT_MSG_IF(m_snapshots > 1 && m_adaptiveLevels > 0,
+                    "Snapshots are not supported with adaptive refinement.");
+
+    if (m_engine == RemEngineType::DIRECT)
     {
-        NS_FATAL_ERROR("Can't open file " << m_outputFile);
-        return;
+        m_probe = CreateObject<ConstantPositionMobilityModel>();
+        m_probe->AggregateObject(CreateObject<MobilityBuildingInfo>());
+    }
+
+    if (m_adaptiveLevels > 0 && !m_gridOutputFile.empty())
+    {
+        NS_LOG_WARN("Adaptive refinement produces a sparse map, which can't be saved as a grid. "
+                    "GridOutputFile is ignored.");
+        m_gridOutputFile.clear();
+    }
+
+    if (!m_outputFile.empty())
+    {
+        m_outFile.open(m_outputFile.c_str());
+        if (!m_outFile.is_open())
+        {
+            NS_FATAL_ERROR("Can't open file " << m_outputFile);
+            return;
+        }
     }
 
+    RemGridHeader header;
+    header.xRes = m_xRes;
+    header.yRes = m_yRes;
+    header.zRes = m_zRes;
+    header.xMin = m_xMin;
+    header.xMax = m_xMax;
+    header.yMin = m_yMin;
+    header.yMax = m_yMax;
+    header.zMin = m_zMin;
+    header.zMax = m_zMax;
+
+    if (!m_gridOutputFile.empty())
+        m_gridFile.Open(m_gridOutputFile, header);
+
+    if (!m_snapshotOutputFile.empty())
+        m_snapshotFile.Open(m_snapshotOutputFile, header);
+
+    if (!m_plyOutputFile.empty())
+        m_plyFile.Open(m_plyOutputFile);
+
     double startDelay = 0.0026;
 
     if (m_useDataChannel)
@@ -256,10 +472,21 @@ void
 ThreeDimensionalRemHelper::DelayedInstall()
 {
     NS_LOG_FUNCTION(this);
+    m_startTime = std::chrono::steady_clock::now();
     m_xStep = (m_xMax - m_xMin) / (m_xRes - 1);
     m_yStep = (m_yMax - m_yMin) / (m_yRes - 1);
     m_zStep = (m_zMax - m_zMin) / (m_zRes - 1);
 
+    if (m_engine == RemEngineType::DIRECT)
+    {
+        // Transmitters are observed for a whole subframe, then the map is evaluated at once
+        m_channel->TraceConnectWithoutContext(
+            "TxSigParams",
+            MakeCallback(&ThreeDimensionalRemHelper::RecordTransmission, this));
+        Simulator::Schedule(MilliSeconds(1), &ThreeDimensionalRemHelper::EvaluateDirect, this);
+        return;
+    }
+
     if (((double)m_xRes * (double)m_yRes < (double)m_pointsPerIteration) ||
         !((m_xRes * m_yRes) % m_pointsPerIteration == 0))
     {
@@ -268,20 +495,29 @@ ThreeDimensionalRemHelper::DelayedInstall()
         m_pointsPerIteration = m_xRes * m_yRes;
     }
 
+    // Listeners are allocated once, in a pool sized to an iteration, and moved by each iteration
+    const auto memoryBefore = GetResidentMemory();
+    const auto rxSpectrumModel = LteSpectrumValueHelper::GetSpectrumModel(m_earfcn, m_bandwidth);
+    m_rem.reserve(m_pointsPerIteration);
     for (uint32_t i = 0; i < m_pointsPerIteration; ++i)
     {
         RemPoint p;
         p.phy = CreateObject<RemSpectrumPhy>();
         p.bmm = CreateObject<ConstantPositionMobilityModel>();
-        Ptr<MobilityBuildingInfo> buildingInfo = CreateObject<MobilityBuildingInfo>();
-        p.bmm->AggregateObject(buildingInfo); // operation usually done by BuildingsHelper::Install
-        p.phy->SetRxSpectrumModel(LteSpectrumValueHelper::GetSpectrumModel(m_earfcn, m_bandwidth));
+        p.buildingInfo = CreateObject<MobilityBuildingInfo>();
+        p.bmm->AggregateObject(p.buildingInfo); // operation usually done by BuildingsHelper::Install
+        p.phy->SetRxSpectrumModel(rxSpectrumModel);
         p.phy->SetMobility(p.bmm);
         p.phy->SetUseDataChannel(m_useDataChannel);
         p.phy->SetRbId(m_rbId);
         m_channel->AddRx(p.phy);
         m_rem.push_back(p);
     }
+    const auto memoryAfter = GetResidentMemory();
+    m_listenerPoolMemory = memoryAfter > memoryBefore ? memoryAfter - memoryBefore : 0;
+    std::cout << "REM listeners pool: " << m_pointsPerIteration << " points, "
+              << m_listenerPoolMemory / 1024 << " KiB ("
+              << m_listenerPoolMemory / m_pointsPerIteration << " bytes/point)" << std::endl;
 
     double remIterationStartTime = 0.0001;
     double xMinNext = m_xMin;
@@ -334,7 +570,7 @@ ThreeDimensionalRemHelper::RunOneIteration(double xMin,
 {
     NS_LOG_FUNCTION(this << xMin << xMax << yMin << yMax << z);
     std::cout << "Computing SINR for z = " << (z) << std::endl;
-    std::list<RemPoint>::iterator remIt = m_rem.begin();
+    std::size_t i = 0;
     double x = 0.0;
     double y = 0.0;
     for (x = xMin; x < xMax + 0.5 * m_xStep; x += m_xStep)
@@ -342,16 +578,14 @@ ThreeDimensionalRemHelper::RunOneIteration(double xMin,
         for (y = (x == xMin) ? yMin : m_yMin; y < ((x == xMax) ? yMax : m_yMax) + 0.5 * m_yStep;
              y += m_yStep)
         {
-            NS_ASSERT(remIt != m_rem.end());
-            remIt->bmm->SetPosition(Vector(x, y, z));
-            Ptr<MobilityBuildingInfo> buildingInfo =
-                (remIt->bmm)->GetObject<MobilityBuildingInfo>();
-            buildingInfo->MakeConsistent(remIt->bmm);
-            ++remIt;
+            NS_ASSERT(i < m_rem.size());
+            m_rem[i].bmm->SetPosition(Vector(x, y, z));
+            m_rem[i].buildingInfo->MakeConsistent(m_rem[i].bmm);
+            ++i;
         }
     }
 
-    if (remIt != m_rem.end())
+    if (i != m_rem.size())
     {
         NS_ASSERT((x > m_xMax - 0.5 * m_xStep) && (y > m_yMax - 0.5 * m_yStep));
         NS_FATAL_ERROR("Some points were not used, something went wrong, check the attribute "
@@ -366,31 +600,668 @@ ThreeDimensionalRemHelper::PrintAndReset()
 {
     NS_LOG_FUNCTION(this);
 
-    for (std::list<RemPoint>::iterator it = m_rem.begin(); it != m_rem.end(); ++it)
+    std::vector<float> grid;
+    if (m_gridFile.IsOpen())
+        grid.reserve(m_rem.size());
+
+    for (auto it = m_rem.begin(); it != m_rem.end(); ++it)
+    {
+        const double sinr = it->phy->GetSinr(m_noisePower);
+        const Vector pos = it->bmm->GetPosition();
+        WritePoint(pos, sinr);
+        if (m_gridFile.IsOpen())
+            grid.push_back(sinr);
+        it->phy->Reset();
+    }
+    if (m_gridFile.IsOpen())
+        m_gridFile.Write(grid.data(), grid.size());
+    m_evaluatedPoints += m_rem.size();
+}
+
+uint64_t
+ThreeDimensionalRemHelper::GetEvaluatedPoints() const
+{
+    return m_evaluatedPoints;
+}
+
+double
+ThreeDimensionalRemHelper::GetPointsPerSecond() const
+{
+    const auto end = m_done ? m_endTime : std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed = end - m_startTime;
+    return elapsed.count() > 0. ? m_evaluatedPoints / elapsed.count() : 0.;
+}
+
+uint64_t
+ThreeDimensionalRemHelper::GetListenerPoolMemory() const
+{
+    return m_listenerPoolMemory;
+}
+
+void
+ThreeDimensionalRemHelper::RecordTransmission(Ptr<SpectrumSignalParameters> params)
+{
+    NS_LOG_FUNCTION(this << params);
+
+    bool isMapped = true;
+    if (m_signals == RemSignalType::LTE_DL_SIGNALS)
+    {
+        isMapped = m_useDataChannel
+                       ? bool(DynamicCast<LteSpectrumSignalParametersDataFrame>(params))
+                       : bool(DynamicCast<LteSpectrumSignalParametersDlCtrlFrame>(params));
+    }
+    if (!isMapped || !params->txPhy)
+        return;
+
+    for (const auto& tx : m_txs)
+        if (tx.params->txPhy == params->txPhy)
+            return;
+
+    RemTransmitter tx;
+    tx.params = params->Copy();
+    // Other signals are measured over their own spectrum model
+    const auto remModel = LteSpectrumValueHelper::GetSpectrumModel(m_earfcn, m_bandwidth);
+    if (m_signals == RemSignalType::LTE_DL_SIGNALS &&
+        params->psd->GetSpectrumModelUid() != remModel->GetUid())
+    {
+        tx.params->psd =
+            SpectrumConverter(params->psd->GetSpectrumModel(), remModel).Convert(params->psd);
+    }
+    tx.mobility = params->txPhy->GetMobility();
+    tx.power = GetPsdPower(*tx.params->psd);
+    m_txs.push_back(tx);
+}
+
+void
+ThreeDimensionalRemHelper::EvaluateDirect()
+{
+    NS_LOG_FUNCTION(this);
+    // Snapshots keep observing the channel, to include transmitters that appear later on
+    const bool lastSnapshot = m_snapshot + 1 >= m_snapshots;
+    if (lastSnapshot)
+    {
+        m_channel->TraceDisconnectWithoutContext(
+            "TxSigParams",
+            MakeCallback(&ThreeDimensionalRemHelper::RecordTransmission, this));
+    }
+
+    m_irsChannel = DynamicCast<IrsAssistedSpectrumChannel>(m_channel);
+    m_propagationLoss = m_channel->GetPropagationLossModel();
+    m_spectrumLoss = m_channel->GetSpectrumPropagationLossModel();
+
+    // 3GPP models draw the condition and the fading of a link once per pair of nodes, thus they
+    // would give every point of the map the outcome drawn for the first one
+    for (auto model = m_propagationLoss; model; model = model->GetNext())
+        NS_ABORT_MSG_IF(IsThreeGppModel(model),
+                        "3GPP propagation loss models are not supported by the DIRECT engine.");
+    NS_ABORT_MSG_IF(IsThreeGppModel(m_channel->GetPhasedArraySpectrumPropagationLossModel()),
+                    "3GPP spectrum propagation loss models are not supported by the DIRECT "
+                    "engine.");
+
+    if (m_channel->GetPhasedArraySpectrumPropagationLossModel())
+        NS_LOG_WARN("Phased array spectrum propagation loss models are not supported by the "
+                    "DIRECT engine, the map only accounts for the propagation loss model");
+    DoubleValue maxLossDb(std::numeric_limits<double>::infinity());
+    m_channel->GetAttributeFailSafe("MaxLossDb", maxLossDb);
+    m_maxLossDb = maxLossDb.Get();
+
+    if (m_txs.empty())
+        NS_LOG_WARN("No transmission has been observed, the map will be empty");
+
+    const bool parallel = m_nThreads > 1 && IsThreadSafe();
+    if (m_nThreads > 1 && !parallel)
+        NS_LOG_WARN("Propagation or antenna models are not known to be thread-safe, the map will "
+                    "be evaluated by a single thread");
+
+    // Each thread works on its own copy of the positions, thus it does not share any ns-3 object
+    // with the others. Buildings information is only needed by models that are not thread-safe.
+    m_contexts.resize(parallel ? m_nThreads : 1);
+    for (auto& ctx : m_contexts)
     {
-        if (std::isgreaterequal(it->phy->GetSinr(m_noisePower), m_threshold))
+        if (parallel)
         {
-            Vector pos = it->bmm->GetPosition();
-            NS_LOG_LOGIC("output: " << pos.x << "\t" << pos.y << "\t" << pos.z << "\t"
-                                    << it->phy->GetSinr(m_noisePower));
-            m_outFile << pos.x << "\t" << pos.y << "\t" << pos.z << "\t"
-                      << it->phy->GetSinr(m_noisePower) << std::endl;
+            ctx.probe = CreateObject<ConstantPositionMobilityModel>();
         }
-        it->phy->Reset();
+        else
+        {
+            ctx.probe = m_probe;
+            ctx.buildingInfo = m_probe->GetObject<MobilityBuildingInfo>();
+        }
+
+        for (const auto& tx : m_txs)
+        {
+            if (parallel)
+            {
+                Ptr<MobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel>();
+                txMobility->SetPosition(tx.mobility->GetPosition());
+                ctx.txMobility.push_back(txMobility);
+            }
+            else
+            {
+                ctx.txMobility.push_back(tx.mobility);
+            }
+        }
+    }
+
+    if (parallel)
+        m_pool = std::make_unique<WorkerPool>(m_nThreads);
+
+    if (m_snapshots > 1)
+        EvaluateSnapshot();
+    else if (m_adaptiveLevels > 0)
+        EvaluateAdaptive();
+    else
+        EvaluateGrid();
+
+    m_pool.reset();
+    m_contexts.clear();
+
+    if (!lastSnapshot)
+    {
+        ++m_snapshot;
+        Simulator::Schedule(m_snapshotInterval, &ThreeDimensionalRemHelper::EvaluateDirect, this);
+        return;
+    }
+
+    m_txs.clear();
+    m_contributions.clear();
+    m_contributionPositions.clear();
+    m_contributionIrsState = {};
+    Finalize();
+}
+
+void
+ThreeDimensionalRemHelper::EvaluateGrid()
+{
+    NS_LOG_FUNCTION(this);
+
+    const std::size_t sliceSize = static_cast<std::size_t>(m_xRes) * m_yRes;
+    std::vector<Vector> positions(sliceSize);
+    std::vector<double> sinr;
+    std::vector<float> grid(m_gridFile.IsOpen() ? sliceSize : 0);
+    for (uint32_t iz = 0; iz < m_zRes; ++iz)
+    {
+        const double z = m_zMin + iz * m_zStep;
+        std::cout << "Computing SINR for z = " << z << std::endl;
+
+        for (std::size_t i = 0; i < sliceSize; ++i)
+            positions[i] = {m_xMin + (i / m_yRes) * m_xStep, m_yMin + (i % m_yRes) * m_yStep, z};
+        EvaluateBatch(positions, sinr);
+
+        for (std::size_t i = 0; i < sliceSize; ++i)
+            WritePoint(positions[i], sinr[i]);
+        if (m_gridFile.IsOpen())
+        {
+            std::copy(sinr.begin(), sinr.end(), grid.begin());
+            m_gridFile.Write(grid.data(), grid.size());
+        }
+    }
+}
+
+void
+ThreeDimensionalRemHelper::EvaluateAdaptive()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Points lie on the lattice of the finest level, cells are cubes of the lattice identified by
+    // their lower corner and their side. The index of a point follows the order of the grid.
+    const uint64_t side = uint64_t{1} << m_adaptiveLevels;
+    const uint64_t nx = (m_xRes - 1) * side + 1;
+    const uint64_t ny = (m_yRes - 1) * side + 1;
+    const uint64_t nz = (m_zRes - 1) * side + 1;
+    NS_ABORT_MSG_IF(static_cast<double>(nx) * ny * nz >
+                        static_cast<double>(std::numeric_limits<uint64_t>::max()),
+                    "Too many adaptive levels for the resolution of the map");
+    const auto index = [nx, ny](uint64_t ix, uint64_t iy, uint64_t iz) {
+        return (iz * nx + ix) * ny + iy;
+    };
+    const auto position = [&](uint64_t i) -> Vector {
+        return {m_xMin + ((i / ny) % nx) * m_xStep / side,
+                m_yMin + (i % ny) * m_yStep / side,
+                m_zMin + (i / ny / nx) * m_zStep / side};
+    };
+
+    struct Cell
+    {
+        uint64_t ix;
+        uint64_t iy;
+        uint64_t iz;
+        uint64_t side;
+    };
+
+    std::unordered_map<uint64_t, double> values;
+    std::vector<uint64_t> pending;
+    std::vector<Vector> positions;
+    std::vector<double> sinr;
+    // Request the evaluation of the points of a cell, spaced by step
+    const auto request = [&](const Cell& cell, uint64_t step) {
+        for (uint64_t dz = 0; dz <= cell.side; dz += step)
+            for (uint64_t dx = 0; dx <= cell.side; dx += step)
+                for (uint64_t dy = 0; dy <= cell.side; dy += step)
+                {
+                    const auto i = index(cell.ix + dx, cell.iy + dy, cell.iz + dz);
+                    if (values.emplace(i, 0.).second)
+                        pending.push_back(i);
+                }
+    };
+    const auto evaluatePending = [&]() {
+        positions.resize(pending.size());
+        for (std::size_t i = 0; i < pending.size(); ++i)
+            positions[i] = position(pending[i]);
+        EvaluateBatch(positions, sinr);
+        for (std::size_t i = 0; i < pending.size(); ++i)
+            values[pending[i]] = sinr[i];
+        pending.clear();
+    };
+
+    std::cout << "Computing SINR for the coarse grid" << std::endl;
+    std::vector<Cell> cells;
+    for (uint64_t iz = 0; iz + 1 < m_zRes; ++iz)
+        for (uint64_t ix = 0; ix + 1 < m_xRes; ++ix)
+            for (uint64_t iy = 0; iy + 1 < m_yRes; ++iy)
+            {
+                cells.push_back({ix * side, iy * side, iz * side, side});
+                request(cells.back(), side);
+            }
+    evaluatePending();
+
+    for (uint32_t level = 1; level <= m_adaptiveLevels && !cells.empty(); ++level)
+    {
+        std::vector<Cell> children;
+        for (const auto& cell : cells)
+        {
+            double min = std::numeric_limits<double>::infinity();
+            double max = 0.;
+            for (uint64_t dz = 0; dz <= cell.side; dz += cell.side)
+                for (uint64_t dx = 0; dx <= cell.side; dx += cell.side)
+                    for (uint64_t dy = 0; dy <= cell.side; dy += cell.side)
+                    {
+                        const double v = values[index(cell.ix + dx, cell.iy + dy, cell.iz + dz)];
+                        min = std::min(min, v);
+                        max = std::max(max, v);
+                    }
+            if (!NeedsRefinement(min, max))
+                continue;
+
+            const uint64_t half = cell.side / 2;
+            request(cell, half);
+            for (uint64_t dz = 0; dz <= half; dz += half)
+                for (uint64_t dx = 0; dx <= half; dx += half)
+                    for (uint64_t dy = 0; dy <= half; dy += half)
+                        children.push_back({cell.ix + dx, cell.iy + dy, cell.iz + dz, half});
+        }
+
+        std::cout << "Refining " << children.size() / 8 << " cells at level " << level
+                  << std::endl;
+        evaluatePending();
+        cells = std::move(children);
+    }
+
+    std::vector<uint64_t> points;
+    points.reserve(values.size());
+    for (const auto& value : values)
+        points.push_back(value.first);
+    std::sort(points.begin(), points.end());
+    for (const auto i : points)
+        WritePoint(position(i), values[i]);
+
+    std::cout << "Adaptive REM: " << points.size() << " points evaluated, "
+              << 100. * points.size() / (static_cast<double>(nx) * ny * nz)
+              << "% of the uniform grid at the finest level" << std::endl;
+}
+
+void
+ThreeDimensionalRemHelper::EvaluateSnapshot()
+{
+    NS_LOG_FUNCTION(this);
+
+    const std::size_t sliceSize = static_cast<std::size_t>(m_xRes) * m_yRes;
+    const std::size_t nPoints = sliceSize * m_zRes;
+    std::vector<Vector> positions(nPoints);
+    for (std::size_t i = 0; i < nPoints; ++i)
+    {
+        positions[i] = {m_xMin + ((i / m_yRes) % m_xRes) * m_xStep,
+                        m_yMin + (i % m_yRes) * m_yStep,
+                        m_zMin + (i / sliceSize) * m_zStep};
+    }
+
+    // The contribution of a transmitter is only recomputed if it moved since it was cached, or if
+    // the IRSs reflecting it moved or were steered
+    bool irsChanged = false;
+    if (m_irsChannel)
+    {
+        const auto irsState = GetIrsState();
+        irsChanged = HasIrsStateChanged(irsState);
+        if (irsChanged)
+            m_contributionIrsState = irsState;
+    }
+
+    uint32_t recomputed = 0;
+    m_contributions.resize(m_txs.size());
+    m_contributionPositions.resize(m_txs.size());
+    for (std::size_t k = 0; k < m_txs.size(); ++k)
+    {
+        const Vector txPosition = m_txs[k].mobility->GetPosition();
+        if (!irsChanged && !m_contributions[k].empty() &&
+            CalculateDistance(txPosition, m_contributionPositions[k]) <= m_snapshotTolerance)
+            continue;
+
+        GetContribution(k, positions, m_contributions[k]);
+        m_contributionPositions[k] = txPosition;
+        ++recomputed;
+    }
+
+    std::vector<float> frame(nPoints);
+    for (std::size_t i = 0; i < nPoints; ++i)
+    {
+        const double sinr = CombineContributions(m_contributions, i);
+        frame[i] = sinr;
+
+        // The first snapshot is also saved to the usual outputs
+        if (m_snapshot == 0)
+            WritePoint(positions[i], sinr);
+    }
+    m_evaluatedPoints += nPoints;
+
+    if (m_snapshot == 0 && m_gridFile.IsOpen())
+        m_gridFile.Write(frame.data(), frame.size());
+
+    std::cout << "REM snapshot " << m_snapshot << " at " << Simulator::Now().As(Time::S) << ": "
+              << recomputed << " of " << m_txs.size() << " transmitters recomputed";
+    if (m_snapshotFile.IsOpen())
+    {
+        std::cout << ", " << m_snapshotFile.Write(Simulator::Now().GetSeconds(), frame)
+                  << " points changed";
+    }
+    std::cout << std::endl;
+}
+
+ThreeDimensionalRemHelper::IrsState
+ThreeDimensionalRemHelper::GetIrsState() const
+{
+    IrsState state;
+    for (auto& irs : IrsList())
+    {
+        state.positions.push_back(irs->GetDrone()->GetObject<MobilityModel>()->GetPosition());
+        for (const auto axis : irs->GetRotoAxis())
+            state.steering.push_back(static_cast<double>(axis));
+        for (const auto angle : irs->GetRotoAngles())
+            state.steering.push_back(angle);
+
+        // Same parameters read by IrsAssistedSpectrumChannel to steer each patch
+        for (const auto& patch : irs->GetPatchVector())
+        {
+            state.steering.push_back(patch->IsServing());
+            if (patch->IsServing())
+            {
+                const auto servedNodes = patch->GetServedNodes();
+                state.steering.push_back(servedNodes.first->GetId());
+                state.steering.push_back(servedNodes.second->GetId());
+                state.positions.push_back(
+                    servedNodes.first->GetObject<MobilityModel>()->GetPosition());
+                state.positions.push_back(
+                    servedNodes.second->GetObject<MobilityModel>()->GetPosition());
+            }
+            else
+            {
+                state.steering.push_back(patch->GetPhaseX());
+                state.steering.push_back(patch->GetPhaseY());
+            }
+        }
+    }
+
+    return state;
+}
+
+bool
+ThreeDimensionalRemHelper::HasIrsStateChanged(const IrsState& state) const
+{
+    if (state.steering != m_contributionIrsState.steering ||
+        state.positions.size() != m_contributionIrsState.positions.size())
+        return true;
+
+    for (std::size_t i = 0; i < state.positions.size(); ++i)
+    {
+        if (CalculateDistance(state.positions[i], m_contributionIrsState.positions[i]) >
+            m_snapshotTolerance)
+            return true;
+    }
+
+    return false;
+}
+
+void
+ThreeDimensionalRemHelper::EvaluateBatch(const std::vector<Vector>& positions,
+                                         std::vector<double>& sinr)
+{
+    sinr.resize(positions.size());
+    if (m_irsChannel)
+    {
+        // The IRS channel evaluates a whole batch of positions per transmitter
+        std::vector<std::vector<double>> contributions(m_txs.size());
+        for (std::size_t k = 0; k < m_txs.size(); ++k)
+            GetContribution(k, positions, contributions[k]);
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            sinr[i] = CombineContributions(contributions, i);
+    }
+    else
+    {
+        ForEachPoint(positions.size(), [&](DirectContext& ctx, std::size_t i) {
+            sinr[i] = EvaluatePoint(ctx, positions[i]);
+        });
+    }
+    m_evaluatedPoints += positions.size();
+}
+
+void
+ThreeDimensionalRemHelper::GetContribution(std::size_t k,
+                                           const std::vector<Vector>& positions,
+                                           std::vector<double>& power)
+{
+    const auto& tx = m_txs[k];
+    power.resize(positions.size());
+    if (m_irsChannel)
+    {
+        // Same link budget of IrsAssistedSpectrumChannel, RemSpectrumPhy has no antenna
+        const auto gains = m_irsChannel->GetGains(tx.params, positions);
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            const bool inRange = gains[i] > 0. && -10. * std::log10(gains[i]) < m_maxLossDb;
+            power[i] = inRange ? tx.power * gains[i] : 0.;
+        }
+        return;
+    }
+
+    ForEachPoint(positions.size(), [&](DirectContext& ctx, std::size_t i) {
+        PlaceProbe(ctx, positions[i]);
+        power[i] = GetRxPower(tx, ctx.txMobility[k], ctx.probe);
+    });
+}
+
+double
+ThreeDimensionalRemHelper::CombineContributions(
+    const std::vector<std::vector<double>>& contributions,
+    std::size_t i) const
+{
+    // Same SINR of EvaluatePoint, in the same order of the transmitters
+    double sumPower = 0.;
+    double referenceSignalPower = 0.;
+    for (const auto& contribution : contributions)
+    {
+        sumPower += contribution[i];
+        if (contribution[i] > referenceSignalPower)
+            referenceSignalPower = contribution[i];
+    }
+
+    return referenceSignalPower / (sumPower - referenceSignalPower + m_noisePower);
+}
+
+void
+ThreeDimensionalRemHelper::ForEachPoint(std::size_t n,
+                                        const std::function<void(DirectContext&, std::size_t)>& f)
+{
+    // Points are partitioned in contiguous ranges, one per context
+    const auto evaluate = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t)
+        {
+            const auto first = n * t / m_contexts.size();
+            const auto last = n * (t + 1) / m_contexts.size();
+            for (std::size_t i = first; i < last; ++i)
+                f(m_contexts[t], i);
+        }
+    };
+
+    if (m_pool)
+        m_pool->ParallelFor(m_contexts.size(), evaluate);
+    else
+        evaluate(0, m_contexts.size());
+}
+
+void
+ThreeDimensionalRemHelper::PlaceProbe(DirectContext& ctx, const Vector& position) const
+{
+    ctx.probe->SetPosition(position);
+    if (ctx.buildingInfo)
+        ctx.buildingInfo->MakeConsistent(ctx.probe);
+}
+
+bool
+ThreeDimensionalRemHelper::NeedsRefinement(double min, double max) const
+{
+    // The cell crosses the threshold, thus the boundary of the coverage lies inside it
+    if (min < m_threshold && max >= m_threshold)
+        return true;
+    if (max <= 0.)
+        return false;
+    if (min <= 0.)
+        return true;
+    return 10. * std::log10(max / min) > m_adaptiveTolerance;
+}
+
+bool
+ThreeDimensionalRemHelper::IsThreadSafe() const
+{
+    // Models whose gain only depends on the positions of the nodes and their attributes
+    static const std::set<std::string> lossModels{"ns3::Cost231PropagationLossModel",
+                                                  "ns3::FixedRssLossModel",
+                                                  "ns3::FriisPropagationLossModel",
+                                                  "ns3::Kun2600MhzPropagationLossModel",
+                                                  "ns3::LogDistancePropagationLossModel",
+                                                  "ns3::OkumuraHataPropagationLossModel",
+                                                  "ns3::RangePropagationLossModel",
+                                                  "ns3::ThreeLogDistancePropagationLossModel",
+                                                  "ns3::TwoRayGroundPropagationLossModel"};
+    static const std::set<std::string> antennaModels{"ns3::CosineAntennaModel",
+                                                     "ns3::IsotropicAntennaModel",
+                                                     "ns3::ParabolicAntennaModel"};
+
+    if (m_spectrumLoss || m_irsChannel)
+        return false;
+
+    for (auto model = m_propagationLoss; model; model = model->GetNext())
+        if (lossModels.find(model->GetInstanceTypeId().GetName()) == lossModels.end())
+            return false;
+
+    for (const auto& tx : m_txs)
+        if (tx.params->txAntenna && antennaModels.find(tx.params->txAntenna->GetInstanceTypeId()
+                                                           .GetName()) == antennaModels.end())
+            return false;
+
+    return true;
+}
+
+double
+ThreeDimensionalRemHelper::EvaluatePoint(DirectContext& ctx, const Vector& position) const
+{
+    PlaceProbe(ctx, position);
+
+    // Same SINR of RemSpectrumPhy: the strongest transmitter against all the others
+    double sumPower = 0.;
+    double referenceSignalPower = 0.;
+    for (std::size_t k = 0; k < m_txs.size(); ++k)
+    {
+        const double power = GetRxPower(m_txs[k], ctx.txMobility[k], ctx.probe);
+        sumPower += power;
+        if (power > referenceSignalPower)
+            referenceSignalPower = power;
     }
+
+    return referenceSignalPower / (sumPower - referenceSignalPower + m_noisePower);
+}
+
+double
+ThreeDimensionalRemHelper::GetRxPower(const RemTransmitter& tx,
+                                      Ptr<MobilityModel> txMobility,
+                                      Ptr<MobilityModel> probe) const
+{
+    // Same link budget of MultiModelSpectrumChannel, RemSpectrumPhy has no antenna
+    double pathLossDb = 0.;
+    if (tx.params->txAntenna)
+    {
+        const Angles txAngles{probe->GetPosition(), txMobility->GetPosition()};
+        pathLossDb -= tx.params->txAntenna->GetGainDb(txAngles);
+    }
+    if (m_propagationLoss)
+        pathLossDb -= m_propagationLoss->CalcRxPower(0., txMobility, probe);
+
+    if (pathLossDb > m_maxLossDb)
+        return 0.;
+
+    const double pathGain = std::pow(10., -pathLossDb / 10.);
+    if (!m_spectrumLoss)
+        return tx.power * pathGain;
+
+    auto rxParams = tx.params->Copy();
+    *(rxParams->psd) *= pathGain;
+    return GetPsdPower(*m_spectrumLoss->CalcRxPowerSpectralDensity(rxParams, txMobility, probe));
+}
+
+double
+ThreeDimensionalRemHelper::GetPsdPower(const SpectrumValue& psd) const
+{
+    if (m_rbId >= 0 && m_signals == RemSignalType::LTE_DL_SIGNALS)
+        return psd[m_rbId] * 180000;
+    else
+        return Integral(psd);
 }
 
 void
 ThreeDimensionalRemHelper::Finalize()
 {
     NS_LOG_FUNCTION(this);
-    m_outFile.close();
+    m_endTime = std::chrono::steady_clock::now();
+    m_done = true;
+    std::cout << "REM completed: " << m_evaluatedPoints << " points, " << GetPointsPerSecond()
+              << " points/s" << std::endl;
+    if (m_outFile.is_open())
+        m_outFile.close();
+    if (m_gridFile.IsOpen())
+        m_gridFile.Close();
+    if (m_plyFile.IsOpen())
+        m_plyFile.Close();
+    if (m_snapshotFile.IsOpen())
+        m_snapshotFile.Close();
     if (m_stopWhenDone)
     {
         Simulator::Stop();
     }
 }
 
+void
+ThreeDimensionalRemHelper::WritePoint(const Vector& position, const double sinr)
+{
+    if (!std::isgreaterequal(sinr, m_threshold))
+        return;
+
+    NS_LOG_LOGIC("output: " << position.x << "\t" << position.y << "\t" << position.z << "\t"
+                            << sinr);
+    if (m_outFile.is_open())
+        m_outFile << position.x << "\t" << position.y << "\t" << position.z << "\t" << sinr
+                  << "\n";
+    if (m_plyFile.IsOpen())
+        m_plyFile.Write(position.x, position.y, position.z, sinr);
+}
+
 void
 ThreeDimensionalRemHelper::SetThresholdDb(double threshDb)
 {
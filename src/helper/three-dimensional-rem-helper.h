@@ -20,10 +20,18 @@
 #ifndef THREE_DIMENSIONAL_REM_HELPER_H
 #define THREE_DIMENSIONAL_REM_HELPER_H
 
+#include <ns3/nstime.h>
 #include <ns3/object.h>
+#include <ns3/rem-output.h>
 #include <ns3/rem-spectrum-phy.h>
+#include <ns3/vector.h>
+#include <ns3/worker-pool.h>
 
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace ns3
 {
@@ -32,12 +40,41 @@ class Node;
 class NetDevice;
 class SpectrumChannel;
 class MobilityModel;
+class MobilityBuildingInfo;
+class PropagationLossModel;
+class SpectrumPropagationLossModel;
+class SpectrumSignalParameters;
+class SpectrumValue;
+class IrsAssistedSpectrumChannel;
+
+/**
+ * \ingroup lte
+ *
+ * Engine used by ThreeDimensionalRemHelper to compute the map.
+ */
+enum RemEngineType
+{
+    LISTENERS = 0, // RemSpectrumPhy listeners collect the transmissions in simulated time
+    DIRECT = 1     // The link budget of each point is evaluated directly, without listeners
+};
+
+/**
+ * \ingroup lte
+ *
+ * Transmissions ThreeDimensionalRemHelper computes the map for.
+ */
+enum RemSignalType
+{
+    LTE_DL_SIGNALS = 0, // LTE downlink control or data frames
+    ALL_SIGNALS = 1     // Any transmission on the channel
+};
 
 /**
  * \ingroup lte
  *
  * Generates a 3D map of the SINR from the strongest transmitter in the
- * downlink of an LTE FDD system.
+ * downlink of an LTE FDD system. The DIRECT engine can also map any other
+ * transmission on a SpectrumChannel, including the IrsAssistedSpectrumChannel.
  */
 class ThreeDimensionalRemHelper : public Object
 {
@@ -50,6 +87,8 @@ class ThreeDimensionalRemHelper : public Object
      */
     static TypeId GetTypeId();
 
+    ThreeDimensionalRemHelper();
+
     /**
      * \return the data converted from dB to linear scale.
      */
@@ -69,9 +108,29 @@ class ThreeDimensionalRemHelper : public Object
     /**
      * Deploy the RemSpectrumPhy objects that generate the map according to the specified settings.
      *
+     * The DIRECT engine evaluates every point with the same probe, which is not attached to any
+     * Node. Hence, it does not support the 3GPP models, which cache their outcome per pair of
+     * nodes.
      */
     void Install();
 
+    /**
+     * \return the number of points evaluated so far.
+     */
+    uint64_t GetEvaluatedPoints() const;
+
+    /**
+     * \return the number of points evaluated per second of wall-clock time, from the start of the
+     * map generation to its completion (or to now, if still in progress).
+     */
+    double GetPointsPerSecond() const;
+
+    /**
+     * \return the resident memory, in bytes, taken by the pool of listeners of the LISTENERS
+     * engine, as measured while it was allocated. It is zero if it cannot be measured.
+     */
+    uint64_t GetListenerPoolMemory() const;
+
   private:
     /**
      * Scheduled by Install() to perform the actual generation of map.
@@ -105,9 +164,173 @@ class ThreeDimensionalRemHelper : public Object
     /// Called when the map generation procedure has been completed.
     void Finalize();
 
+    /**
+     * Write a point to the text and PLY outputs, if its SINR is not below the threshold.
+     *
+     * \param position the position of the point.
+     * \param sinr the SINR of the point, in linear units.
+     */
+    void WritePoint(const Vector& position, double sinr);
+
     /// Set threshold parameter in dB
     void SetThresholdDb(double threshDb);
 
+    /// A transmission observed by the DIRECT engine.
+    struct RemTransmitter
+    {
+        /// Parameters of the transmission, with the PSD converted to the REM spectrum model.
+        Ptr<SpectrumSignalParameters> params;
+        /// Position of the transmitter.
+        Ptr<MobilityModel> mobility;
+        /// Power that would be received with a unitary channel gain.
+        double power;
+    };
+
+    /// Objects used to evaluate the link budget of points, private to a thread.
+    struct DirectContext
+    {
+        /// Position of the point being evaluated.
+        Ptr<MobilityModel> probe;
+        /// Buildings information of the point, if needed by the propagation models.
+        Ptr<MobilityBuildingInfo> buildingInfo;
+        /// Position of each transmitter.
+        std::vector<Ptr<MobilityModel>> txMobility;
+    };
+
+    /// State of the IRSs the gains of an IrsAssistedSpectrumChannel depend on.
+    struct IrsState
+    {
+        /// Positions of the IRSs and of the nodes served by their patches.
+        std::vector<Vector> positions;
+        /// Orientation of the IRSs and steering of their patches.
+        std::vector<double> steering;
+    };
+
+    /**
+     * Trace sink of the transmissions on the channel, recording the ones the map is computed
+     * for. Each transmitter is recorded once.
+     *
+     * \param params the parameters of the transmission.
+     */
+    void RecordTransmission(Ptr<SpectrumSignalParameters> params);
+
+    /// Evaluate the whole map with the DIRECT engine.
+    void EvaluateDirect();
+
+    /// Evaluate the uniform grid, one z-slice at a time.
+    void EvaluateGrid();
+
+    /**
+     * Evaluate the coarse grid, then recursively split in octants the cells whose corners do not
+     * have a uniform SINR, as many times as the AdaptiveLevels attribute.
+     */
+    void EvaluateAdaptive();
+
+    /**
+     * Evaluate a snapshot of the uniform grid, recomputing the power received from the
+     * transmitters that moved since the previous one, and save it as a delta.
+     */
+    void EvaluateSnapshot();
+
+    /**
+     * Evaluate the SINR of a batch of points, in parallel if allowed.
+     *
+     * \param positions the positions of the points.
+     * \param sinr the SINR of each point in linear units, resized as needed.
+     */
+    void EvaluateBatch(const std::vector<Vector>& positions, std::vector<double>& sinr);
+
+    /**
+     * Evaluate the power received from a transmitter in a batch of points.
+     *
+     * \param k the index of the transmitter.
+     * \param positions the positions of the points.
+     * \param power the received power in each point, resized as needed.
+     */
+    void GetContribution(std::size_t k,
+                         const std::vector<Vector>& positions,
+                         std::vector<double>& power);
+
+    /**
+     * \return the current state of the IRSs in the IrsList.
+     */
+    IrsState GetIrsState() const;
+
+    /**
+     * \param state a state of the IRSs.
+     * \return whether the IRSs moved or were steered since the snapshot contributions were
+     * computed. Movements within the `SnapshotTolerance` attribute are ignored.
+     */
+    bool HasIrsStateChanged(const IrsState& state) const;
+
+    /**
+     * Evaluate the SINR of a point from the power received from each transmitter, as
+     * EvaluatePoint would do.
+     *
+     * \param contributions the power received from each transmitter in every point.
+     * \param i the index of the point.
+     * \return the SINR in linear units.
+     */
+    double CombineContributions(const std::vector<std::vector<double>>& contributions,
+                                std::size_t i) const;
+
+    /**
+     * Call a function for each point in [0, n), in parallel if allowed. Points are partitioned
+     * in contiguous ranges, one per context.
+     *
+     * \param n the number of points.
+     * \param f the function, called with the context of the evaluating thread and the point.
+     */
+    void ForEachPoint(std::size_t n, const std::function<void(DirectContext&, std::size_t)>& f);
+
+    /**
+     * Move the probe of a context to a point, updating its buildings information if needed.
+     *
+     * \param ctx the objects of the evaluating thread.
+     * \param position the position of the point.
+     */
+    void PlaceProbe(DirectContext& ctx, const Vector& position) const;
+
+    /**
+     * \param min the minimum SINR among the corners of a cell, in linear units.
+     * \param max the maximum SINR among the corners of a cell, in linear units.
+     * \return whether the cell has to be refined.
+     */
+    bool NeedsRefinement(double min, double max) const;
+
+    /**
+     * \return whether the propagation and antenna models in use can be evaluated concurrently,
+     * i.e., they are known to be stateless and to only read the positions of the nodes.
+     */
+    bool IsThreadSafe() const;
+
+    /**
+     * Evaluate the SINR of a point as RemSpectrumPhy would do.
+     *
+     * \param ctx the objects of the evaluating thread.
+     * \param position the position of the point.
+     * \return the SINR in linear units.
+     */
+    double EvaluatePoint(DirectContext& ctx, const Vector& position) const;
+
+    /**
+     * Evaluate the power received from a transmitter, as computed by RemSpectrumPhy.
+     *
+     * \param tx the transmitter.
+     * \param txMobility the position of the transmitter.
+     * \param probe the position of the receiver.
+     * \return the received power.
+     */
+    double GetRxPower(const RemTransmitter& tx,
+                      Ptr<MobilityModel> txMobility,
+                      Ptr<MobilityModel> probe) const;
+
+    /**
+     * \param psd a received power spectral density.
+     * \return the power measured by RemSpectrumPhy, according to the RbId attribute.
+     */
+    double GetPsdPower(const SpectrumValue& psd) const;
+
     /// A complete Radio Environment Map is composed of many of this structure.
     struct RemPoint
     {
@@ -115,10 +338,12 @@ class ThreeDimensionalRemHelper : public Object
         Ptr<RemSpectrumPhy> phy;
         /// Position of the listener in the environment.
         Ptr<MobilityModel> bmm;
+        /// Buildings information of the listener.
+        Ptr<MobilityBuildingInfo> buildingInfo;
     };
 
-    /// List of listeners in the environment.
-    std::list<RemPoint> m_rem;
+    /// Pool of listeners in the environment, reused by every iteration.
+    std::vector<RemPoint> m_rem;
 
     double m_xMin;   ///< The `XMin` attribute.
     double m_xMax;   ///< The `XMax` attribute.
@@ -165,9 +390,49 @@ class ThreeDimensionalRemHelper : public Object
 
     std::ofstream m_outFile; ///< Stream the output to a file.
 
+    std::string m_gridOutputFile; ///< The `GridOutputFile` attribute.
+    RemGridWriter m_gridFile;     ///< Stream the whole grid to a binary file.
+    std::string m_plyOutputFile;  ///< The `PlyOutputFile` attribute.
+    RemPlyWriter m_plyFile;       ///< Stream the points above the threshold to a PLY file.
+
     bool m_useDataChannel; ///< The `UseDataChannel` attribute.
     int32_t m_rbId;        ///< The `RbId` attribute.
 
+    RemEngineType m_engine;  ///< The `Engine` attribute.
+    uint32_t m_nThreads;     ///< The `Threads` attribute.
+    RemSignalType m_signals; ///< The `Signals` attribute.
+
+    std::vector<RemTransmitter> m_txs;                ///< Transmitters seen by the DIRECT engine
+    Ptr<PropagationLossModel> m_propagationLoss;      ///< Propagation loss model of the channel
+    Ptr<SpectrumPropagationLossModel> m_spectrumLoss; ///< Spectrum loss model of the channel
+    Ptr<IrsAssistedSpectrumChannel> m_irsChannel;     ///< The channel, if IRS-assisted
+    double m_maxLossDb;                               ///< Maximum loss of the channel
+    Ptr<MobilityModel> m_probe;                       ///< Probe of the single-threaded engine
+    std::vector<DirectContext> m_contexts;            ///< Objects private to each thread
+    std::unique_ptr<WorkerPool> m_pool;               ///< Threads of the DIRECT engine, if any
+
+    uint32_t m_adaptiveLevels;  ///< The `AdaptiveLevels` attribute.
+    double m_adaptiveTolerance; ///< The `AdaptiveTolerance` attribute.
+
+    uint32_t m_snapshots;             ///< The `Snapshots` attribute.
+    Time m_snapshotInterval;          ///< The `SnapshotInterval` attribute.
+    double m_snapshotTolerance;       ///< The `SnapshotTolerance` attribute.
+    std::string m_snapshotOutputFile; ///< The `SnapshotOutputFile` attribute.
+    RemSnapshotWriter m_snapshotFile; ///< Stream the snapshots to a binary file.
+    uint32_t m_snapshot;              ///< Index of the current snapshot.
+    /// Power received from each transmitter in every point of the grid, for the snapshots.
+    std::vector<std::vector<double>> m_contributions;
+    /// Position of each transmitter when its contribution was computed.
+    std::vector<Vector> m_contributionPositions;
+    /// State of the IRSs when the contributions were computed.
+    IrsState m_contributionIrsState;
+
+    uint64_t m_evaluatedPoints;                          ///< Number of points evaluated so far
+    std::chrono::steady_clock::time_point m_startTime; ///< Start of the map generation
+    std::chrono::steady_clock::time_point m_endTime;   ///< Completion of the map generation
+    bool m_done;                                       ///< Whether the map has been completed
+    uint64_t m_listenerPoolMemory;                     ///< Memory taken by the listeners pool
+
 }; // end of `class ThreeDimensionalRemHelper`
 
 } // namespace ns3
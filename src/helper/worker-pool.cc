@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "worker-pool.h"
+
+#include <ns3/log.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("WorkerPool");
+
+WorkerPool::WorkerPool(const uint32_t nThreads)
+    : m_task{nullptr},
+      m_taskSize{0},
+      m_generation{0},
+      m_pending{0},
+      m_stop{false}
+{
+    NS_LOG_FUNCTION(nThreads);
+
+    for (uint32_t i = 1; i < nThreads; ++i)
+        m_workers.emplace_back(&WorkerPool::Work, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    m_wakeUp.notify_all();
+
+    for (auto& w : m_workers)
+        w.join();
+}
+
+uint32_t
+WorkerPool::GetN() const
+{
+    return m_workers.size() + 1;
+}
+
+void
+WorkerPool::ParallelFor(const std::size_t n, const RangeFunction& f)
+{
+    if (m_workers.empty() || n < 2)
+    {
+        f(0, n);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_task = &f;
+        m_taskSize = n;
+        m_pending = m_workers.size();
+        ++m_generation;
+    }
+    m_wakeUp.notify_all();
+
+    RunChunk(0);
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_task = nullptr;
+}
+
+void
+WorkerPool::Work(const uint32_t chunk)
+{
+    uint64_t lastGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_wakeUp.wait(lock, [&] { return m_stop || m_generation != lastGeneration; });
+            if (m_stop)
+                return;
+            lastGeneration = m_generation;
+        }
+
+        RunChunk(chunk);
+
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (--m_pending == 0)
+                m_done.notify_one();
+        }
+    }
+}
+
+void
+WorkerPool::RunChunk(const uint32_t chunk) const
+{
+    const std::size_t nChunks = m_workers.size() + 1;
+    const std::size_t begin = m_taskSize * chunk / nChunks;
+    const std::size_t end = m_taskSize * (chunk + 1) / nChunks;
+
+    if (begin < end)
+        (*m_task)(begin, end);
+}
+
+} // namespace ns3
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup helper
+ *
+ * \brief Fixed-size pool of threads to evaluate data-parallel loops.
+ *
+ * Tasks run outside the simulator context. They must not access ns-3 objects through Ptr, since
+ * reference counting and most models are not thread-safe: gather the needed data beforehand and
+ * let each task write to its own slots of a pre-allocated output.
+ */
+class WorkerPool
+{
+  public:
+    /** Function evaluating the iterations in the range [begin, end). */
+    typedef std::function<void(std::size_t begin, std::size_t end)> RangeFunction;
+
+    /**
+     * \brief Spawn the worker threads.
+     *
+     * \param nThreads the overall number of threads, including the calling one.
+     */
+    WorkerPool(const uint32_t nThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * \returns the overall number of threads, including the calling one.
+     */
+    uint32_t GetN() const;
+
+    /**
+     * \brief Evaluate the iterations in [0, n) splitting them in contiguous chunks, one per
+     *        thread. The calling thread evaluates the first chunk and waits for the others.
+     *
+     * \param n the number of iterations.
+     * \param f the function evaluating a chunk of iterations.
+     */
+    void ParallelFor(const std::size_t n, const RangeFunction& f);
+
+  private:
+    /** Main loop of a worker thread. */
+    void Work(const uint32_t chunk);
+    /** Evaluate the given chunk of the current task. */
+    void RunChunk(const uint32_t chunk) const;
+
+    std::vector<std::thread> m_workers; /// Worker threads, excluding the calling one
+    std::mutex m_mutex;                 /// Protect the state of the current task
+    std::condition_variable m_wakeUp;   /// Signal a new task or the stop request to workers
+    std::condition_variable m_done;     /// Signal that all workers completed their chunk
+    const RangeFunction* m_task;        /// Task being evaluated
+    std::size_t m_taskSize;             /// Number of iterations of the current task
+    uint64_t m_generation;              /// Incremented on every new task
+    uint32_t m_pending;                 /// Number of workers still evaluating the current task
+    bool m_stop;                        /// Whether workers have to terminate
+};
+
+} // namespace ns3
+
+#endif /* WORKER_POOL_H */
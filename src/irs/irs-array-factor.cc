@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "irs-array-factor.h"
+
+#include <ns3/abort.h>
+#include <ns3/log.h>
+
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define IRS_ARRAY_FACTOR_AVX2
+#include <immintrin.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("IrsArrayFactor");
+
+namespace
+{
+
+/**
+ * \brief Check whether a value has no fractional part, as done by the reference implementation
+ * to detect a null denominator of the array factor.
+ *
+ * \param x the value to check.
+ * \returns true if x is integral.
+ */
+inline bool
+IsIntegral(const double x)
+{
+    double integral;
+    return std::modf(x, &integral) == 0.;
+}
+
+#ifdef IRS_ARRAY_FACTOR_AVX2
+
+// Three-part splitting of pi/2 for the Cody-Waite argument reduction (from fdlibm)
+constexpr double PIO2_1 = 1.57079632673412561417e+00;
+constexpr double PIO2_2 = 6.07710050630396597660e-11;
+constexpr double PIO2_3 = 2.02226624871116645580e-21;
+// Largest argument for which the reduction above is accurate
+constexpr double SIN_MAX_ARG = 1e5;
+
+// Minimax coefficients of sin and cos in [-pi/4, pi/4] (from fdlibm)
+constexpr double S1 = -1.66666666666666324348e-01;
+constexpr double S2 = 8.33333333332248946124e-03;
+constexpr double S3 = -1.98412698298579493134e-04;
+constexpr double S4 = 2.75573137070700676789e-06;
+constexpr double S5 = -2.50507602534068634195e-08;
+constexpr double S6 = 1.58969099521155010221e-10;
+constexpr double C1 = 4.16666666666666019037e-02;
+constexpr double C2 = -1.38888888888741095749e-03;
+constexpr double C3 = 2.48015872894767294178e-05;
+constexpr double C4 = -2.75573143513906633035e-07;
+constexpr double C5 = 2.08757232129817482790e-09;
+constexpr double C6 = -1.13596475577881948265e-11;
+
+/**
+ * \brief Sine of four values at once. Lanes beyond SIN_MAX_ARG are computed through libm.
+ *
+ * \param x the arguments.
+ * \returns the sine of each argument.
+ */
+__attribute__((target("avx2,fma"))) inline __m256d
+Avx2Sin(const __m256d x)
+{
+    const __m256d one = _mm256_set1_pd(1.);
+    const __m256d two = _mm256_set1_pd(2.);
+
+    // Reduce the argument to r in [-pi/4, pi/4], with x = j * pi/2 + r
+    const __m256d j = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(M_2_PI)),
+                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(j, _mm256_set1_pd(PIO2_1), x);
+    r = _mm256_fnmadd_pd(j, _mm256_set1_pd(PIO2_2), r);
+    r = _mm256_fnmadd_pd(j, _mm256_set1_pd(PIO2_3), r);
+    const __m256d z = _mm256_mul_pd(r, r);
+
+    __m256d s = _mm256_fmadd_pd(z, _mm256_set1_pd(S6), _mm256_set1_pd(S5));
+    s = _mm256_fmadd_pd(z, s, _mm256_set1_pd(S4));
+    s = _mm256_fmadd_pd(z, s, _mm256_set1_pd(S3));
+    s = _mm256_fmadd_pd(z, s, _mm256_set1_pd(S2));
+    s = _mm256_fmadd_pd(z, s, _mm256_set1_pd(S1));
+    s = _mm256_fmadd_pd(_mm256_mul_pd(r, z), s, r);
+
+    __m256d c = _mm256_fmadd_pd(z, _mm256_set1_pd(C6), _mm256_set1_pd(C5));
+    c = _mm256_fmadd_pd(z, c, _mm256_set1_pd(C4));
+    c = _mm256_fmadd_pd(z, c, _mm256_set1_pd(C3));
+    c = _mm256_fmadd_pd(z, c, _mm256_set1_pd(C2));
+    c = _mm256_fmadd_pd(z, c, _mm256_set1_pd(C1));
+    c = _mm256_fmadd_pd(_mm256_mul_pd(z, z), c, _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, one));
+
+    // Select the polynomial and the sign according to the quadrant j mod 4
+    const __m256d q = _mm256_sub_pd(
+        j,
+        _mm256_mul_pd(_mm256_set1_pd(4.), _mm256_floor_pd(_mm256_mul_pd(j, _mm256_set1_pd(0.25)))));
+    const __m256d odd = _mm256_cmp_pd(
+        _mm256_sub_pd(q, _mm256_mul_pd(two, _mm256_floor_pd(_mm256_mul_pd(q, _mm256_set1_pd(0.5))))),
+        one,
+        _CMP_EQ_OQ);
+    const __m256d negative = _mm256_cmp_pd(q, two, _CMP_GE_OQ);
+    __m256d result = _mm256_blendv_pd(s, c, odd);
+    result = _mm256_xor_pd(result, _mm256_and_pd(negative, _mm256_set1_pd(-0.)));
+
+    const __m256d large = _mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.), x),
+                                        _mm256_set1_pd(SIN_MAX_ARG),
+                                        _CMP_GT_OQ);
+    if (_mm256_movemask_pd(large))
+    {
+        alignas(32) double in[4];
+        alignas(32) double out[4];
+        _mm256_store_pd(in, x);
+        _mm256_store_pd(out, result);
+        for (int i = 0; i < 4; ++i)
+            if (std::fabs(in[i]) > SIN_MAX_ARG)
+                out[i] = std::sin(in[i]);
+        result = _mm256_load_pd(out);
+    }
+
+    return result;
+}
+
+/**
+ * \brief Array factor along one axis, i.e., sin(n * a) / sin(a), or n if a is integral.
+ *
+ * \param n number of PRUs along the axis.
+ * \param a the argument.
+ * \returns the array factor of each lane.
+ */
+__attribute__((target("avx2,fma"))) inline __m256d
+Avx2Chi(const __m256d n, const __m256d a)
+{
+    const __m256d integral =
+        _mm256_cmp_pd(_mm256_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), a, _CMP_EQ_OQ);
+    const __m256d ratio = _mm256_div_pd(Avx2Sin(_mm256_mul_pd(n, a)), Avx2Sin(a));
+    return _mm256_blendv_pd(ratio, n, integral);
+}
+
+#endif /* IRS_ARRAY_FACTOR_AVX2 */
+
+} // namespace
+
+std::size_t
+IrsPatchArray::GetN() const
+{
+    return rows.size();
+}
+
+void
+IrsPatchArray::Add(const uint32_t r,
+                   const uint32_t c,
+                   const double pX,
+                   const double pY,
+                   const double d)
+{
+    rows.push_back(r);
+    cols.push_back(c);
+    phaseX.push_back(pX);
+    phaseY.push_back(pY);
+    distance.push_back(d);
+    nPrus += static_cast<double>(r) * c;
+}
+
+bool
+IrsArrayFactor::IsAvx2Supported()
+{
+#ifdef IRS_ARRAY_FACTOR_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+IrsArrayFactor::KernelType
+IrsArrayFactor::Resolve(const KernelType kernel)
+{
+    switch (kernel)
+    {
+    case AUTO:
+        return IsAvx2Supported() ? AVX2 : SCALAR;
+    case AVX2:
+        NS_ABORT_MSG_UNLESS(IsAvx2Supported(), "The AVX2 array factor kernel is not supported.");
+        return AVX2;
+    default:
+        return SCALAR;
+    }
+}
+
+void
+IrsArrayFactor::Evaluate(const KernelType kernel,
+                         const IrsPatchArray& patches,
+                         const Params& params,
+                         double* modules,
+                         double* phases)
+{
+    if (kernel == AVX2)
+        EvaluateAvx2(patches, params, modules, phases);
+    else
+        EvaluateScalar(patches, params, 0, patches.GetN(), modules, phases);
+}
+
+void
+IrsArrayFactor::EvaluateScalar(const IrsPatchArray& patches,
+                               const Params& params,
+                               const std::size_t begin,
+                               const std::size_t end,
+                               double* modules,
+                               double* phases)
+{
+    for (std::size_t p = begin; p < end; ++p)
+    {
+        const double a_x = params.d_c * (params.baseX - patches.phaseX[p]) * params.k;
+        const double a_y = params.d_r * (params.baseY - patches.phaseY[p]) * params.k;
+
+        // Paper: Formula 19 (Chi). An integral argument means a null denominator
+        double module = params.scale;
+        module *= IsIntegral(a_x) ? patches.cols[p]
+                                  : std::sin(patches.cols[p] * a_x) / std::sin(a_x);
+        module *= IsIntegral(a_y) ? patches.rows[p]
+                                  : std::sin(patches.rows[p] * a_y) / std::sin(a_y);
+
+        modules[p] = module;
+        // Paper: Formula 19 (Omega)
+        phases[p] = -2. * params.k * (params.pathLength - patches.distance[p]);
+    }
+}
+
+#ifdef IRS_ARRAY_FACTOR_AVX2
+__attribute__((target("avx2,fma")))
+#endif
+void
+IrsArrayFactor::EvaluateAvx2(const IrsPatchArray& patches,
+                             const Params& params,
+                             double* modules,
+                             double* phases)
+{
+    std::size_t p = 0;
+#ifdef IRS_ARRAY_FACTOR_AVX2
+    const __m256d k = _mm256_set1_pd(params.k);
+    const __m256d d_c = _mm256_set1_pd(params.d_c);
+    const __m256d d_r = _mm256_set1_pd(params.d_r);
+    const __m256d baseX = _mm256_set1_pd(params.baseX);
+    const __m256d baseY = _mm256_set1_pd(params.baseY);
+    const __m256d scale = _mm256_set1_pd(params.scale);
+    const __m256d pathLength = _mm256_set1_pd(params.pathLength);
+    const __m256d phaseScale = _mm256_set1_pd(-2. * params.k);
+
+    for (; p + 4 <= patches.GetN(); p += 4)
+    {
+        const __m256d a_x = _mm256_mul_pd(
+            _mm256_mul_pd(d_c, _mm256_sub_pd(baseX, _mm256_loadu_pd(&patches.phaseX[p]))),
+            k);
+        const __m256d a_y = _mm256_mul_pd(
+            _mm256_mul_pd(d_r, _mm256_sub_pd(baseY, _mm256_loadu_pd(&patches.phaseY[p]))),
+            k);
+
+        __m256d module = _mm256_mul_pd(scale, Avx2Chi(_mm256_loadu_pd(&patches.cols[p]), a_x));
+        module = _mm256_mul_pd(module, Avx2Chi(_mm256_loadu_pd(&patches.rows[p]), a_y));
+        _mm256_storeu_pd(&modules[p], module);
+
+        const __m256d phase =
+            _mm256_mul_pd(phaseScale,
+                          _mm256_sub_pd(pathLength, _mm256_loadu_pd(&patches.distance[p])));
+        _mm256_storeu_pd(&phases[p], phase);
+    }
+#endif
+
+    EvaluateScalar(patches, params, p, patches.GetN(), modules, phases);
+}
+
+} // namespace ns3
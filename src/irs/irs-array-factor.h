@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IRS_ARRAY_FACTOR_H
+#define IRS_ARRAY_FACTOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup irs
+ *
+ * \brief Steering parameters of the patches of an IRS, stored as a structure of arrays so that
+ * they can be streamed through a vectorized kernel.
+ */
+struct IrsPatchArray
+{
+    std::vector<double> rows;     //!< Number of rows of each patch
+    std::vector<double> cols;     //!< Number of columns of each patch
+    std::vector<double> phaseX;   //!< Phase shift along the X-axis of each patch
+    std::vector<double> phaseY;   //!< Phase shift along the Y-axis of each patch
+    std::vector<double> distance; //!< Length of the path each patch is steered to
+    double nPrus{0.};             //!< Overall number of PRUs of the patches
+
+    /** \returns the number of patches. */
+    std::size_t GetN() const;
+
+    /**
+     * \brief Append a patch.
+     *
+     * \param r number of rows.
+     * \param c number of columns.
+     * \param pX phase shift along the X-axis.
+     * \param pY phase shift along the Y-axis.
+     * \param d length of the path the patch is steered to.
+     */
+    void Add(const uint32_t r, const uint32_t c, const double pX, const double pY, const double d);
+};
+
+/**
+ * \ingroup irs
+ *
+ * \brief Evaluate the array factor (Formula 19 of the reference paper) of every patch of an IRS
+ * for a given pair of endpoints.
+ *
+ * For each patch p, the module is scale * Chi_x(p) * Chi_y(p), where
+ * Chi_x(p) = sin(cols * a_x) / sin(a_x), a_x = k * d_c * (baseX - phaseX[p]), and similarly for
+ * the Y-axis, while the phase is -2 * k * (pathLength - distance[p]).
+ */
+class IrsArrayFactor
+{
+  public:
+    /** Implementation used to evaluate the array factor. */
+    enum KernelType
+    {
+        AUTO = 0,   //!< AVX2 if supported by the CPU, SCALAR otherwise
+        SCALAR = 1, //!< Portable implementation based on libm
+        AVX2 = 2    //!< Vectorized implementation, processing four patches at a time
+    };
+
+    /** Endpoint-dependent parameters shared by all the patches of an IRS. */
+    struct Params
+    {
+        double k;          //!< Half wavenumber, i.e., pi * f_c / c
+        double d_c;        //!< X-side dimension of a PRU
+        double d_r;        //!< Y-side dimension of a PRU
+        double baseX;      //!< Steering component along the X-axis due to the endpoints
+        double baseY;      //!< Steering component along the Y-axis due to the endpoints
+        double scale;      //!< Module of the contribution of a single PRU
+        double pathLength; //!< Length of the path between the endpoints through the IRS
+    };
+
+    /**
+     * \returns whether the AVX2 kernel is available on this build and CPU.
+     */
+    static bool IsAvx2Supported();
+
+    /**
+     * \brief Resolve AUTO to the best kernel available, and check the availability of the others.
+     *
+     * \param kernel the requested kernel.
+     * \returns the kernel that will be used.
+     */
+    static KernelType Resolve(const KernelType kernel);
+
+    /**
+     * \brief Evaluate modules and phases of the reflected contribution of each patch.
+     *
+     * \param kernel the kernel to use, already resolved.
+     * \param patches the patches of the IRS.
+     * \param params endpoint-dependent parameters.
+     * \param modules output modules, with room for patches.GetN() values.
+     * \param phases output phases, with room for patches.GetN() values.
+     */
+    static void Evaluate(const KernelType kernel,
+                         const IrsPatchArray& patches,
+                         const Params& params,
+                         double* modules,
+                         double* phases);
+
+  private:
+    /**
+     * \brief Portable evaluation of the patches in the range [begin, end).
+     */
+    static void EvaluateScalar(const IrsPatchArray& patches,
+                               const Params& params,
+                               const std::size_t begin,
+                               const std::size_t end,
+                               double* modules,
+                               double* phases);
+
+    /**
+     * \brief Vectorized evaluation of all the patches. Trailing ones are left to EvaluateScalar.
+     */
+    static void EvaluateAvx2(const IrsPatchArray& patches,
+                             const Params& params,
+                             double* modules,
+                             double* phases);
+};
+
+} // namespace ns3
+
+#endif /* IRS_ARRAY_FACTOR_H */
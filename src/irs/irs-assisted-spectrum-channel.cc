@@ -25,15 +25,19 @@
 #include <ns3/antenna-model.h>
 #include <ns3/boolean.h>
 #include <ns3/buildings-channel-condition-model.h>
+#include <ns3/constant-position-mobility-model.h>
 #include <ns3/double.h>
 #include <ns3/enum.h>
 #include <ns3/log.h>
+#include <ns3/mobility-building-info.h>
 #include <ns3/mobility-model.h>
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/object.h>
 #include <ns3/packet-burst.h>
 #include <ns3/packet.h>
+#include <ns3/parabolic-antenna-model.h>
+#include <ns3/pointer.h>
 #include <ns3/propagation-delay-model.h>
 #include <ns3/propagation-loss-model.h>
 #include <ns3/simulator.h>
@@ -41,10 +45,14 @@
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/spectrum-value.h>
+#include <ns3/uinteger.h>
 
 #include <algorithm>
 #include <cmath>
+#include <complex>
 #include <iostream>
+#include <limits>
+#include <tuple>
 #include <utility>
 
 constexpr double SPEED_OF_LIGHT = 299792458.0;
@@ -56,10 +64,35 @@ NS_LOG_COMPONENT_DEFINE("IrsAssistedSpectrumChannel");
 
 NS_OBJECT_ENSURE_REGISTERED(IrsAssistedSpectrumChannel);
 
+IrsAssistedSpectrumChannel::IrsAssistedSpectrumChannel()
+    : m_geometryCacheHits{0},
+      m_geometryCacheMisses{0},
+      m_flushPending{false},
+      m_batchCounter{0},
+      m_batchId{0}
+{
+    NS_LOG_FUNCTION(this);
+
+    // NaN never compares equal, thus the first lookup always converts the attributes
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    m_kFactorParams = {nan, nan, nan, 0., 0., 0.};
+}
+
 void
 IrsAssistedSpectrumChannel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("Geometry cache hits: " << m_geometryCacheHits
+                                        << ", misses: " << m_geometryCacheMisses);
+    m_irsGeometryCache.clear();
+    m_linkGeometryCache.clear();
+    m_losCache.clear();
+    m_conditionModel = nullptr;
+    m_maxAntennaGains.clear();
+    m_carrierParams.clear();
+    m_pendingTx.clear();
+    m_workerPool.reset();
+    m_probe = nullptr;
     MultiModelSpectrumChannel::DoDispose();
 }
 
@@ -119,7 +152,93 @@ IrsAssistedSpectrumChannel::GetTypeId(void)
                                                            MultipathInterferenceType::SIMULATED,
                                                            "SIMULATED",
                                                            MultipathInterferenceType::CONSTRUCTIVE,
-                                                           "CONSTRUCTIVE"));
+                                                           "CONSTRUCTIVE"))
+            .AddAttribute(
+                "GainEngine",
+                "Algorithm used to combine the reflected contributions of IRS patches. "
+                "PHASOR performs a coherent sum of the reflected field, PAIRWISE accumulates "
+                "the contribution of each pair of patches, CROSS_CHECK evaluates both and "
+                "aborts the simulation if they disagree",
+                EnumValue(IrsGainEngineType::PHASOR),
+                MakeEnumAccessor<IrsGainEngineType>(&IrsAssistedSpectrumChannel::m_gainEngine),
+                MakeEnumChecker<IrsGainEngineType>(IrsGainEngineType::PHASOR,
+                                                   "PHASOR",
+                                                   IrsGainEngineType::PAIRWISE,
+                                                   "PAIRWISE",
+                                                   IrsGainEngineType::CROSS_CHECK,
+                                                   "CROSS_CHECK"))
+            .AddAttribute("CrossCheckTolerance",
+                          "Maximum relative disagreement between gain engines in CROSS_CHECK "
+                          "mode, normalized to the power of the incoherent field sum",
+                          DoubleValue(1e-9),
+                          MakeDoubleAccessor(&IrsAssistedSpectrumChannel::m_crossCheckTolerance),
+                          MakeDoubleChecker<double>(0.))
+            .AddAttribute(
+                "ArrayFactorKernel",
+                "Implementation of the array factor of IRS patches. AUTO selects AVX2 if "
+                "supported by the CPU, SCALAR otherwise",
+                EnumValue(IrsArrayFactor::AUTO),
+                MakeEnumAccessor<IrsArrayFactor::KernelType>(
+                    &IrsAssistedSpectrumChannel::m_arrayFactorKernel),
+                MakeEnumChecker<IrsArrayFactor::KernelType>(IrsArrayFactor::AUTO,
+                                                            "AUTO",
+                                                            IrsArrayFactor::SCALAR,
+                                                            "SCALAR",
+                                                            IrsArrayFactor::AVX2,
+                                                            "AVX2"))
+            .AddAttribute("GeometryCache",
+                          "Reuse distances, angles, k-factors and IRS patch steering parameters "
+                          "of links whose nodes did not move since the last transmission",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&IrsAssistedSpectrumChannel::m_geometryCacheEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("GeometryCacheTolerance",
+                          "Maximum displacement of a node, in meters, for which its cached "
+                          "link geometry is still considered valid",
+                          DoubleValue(0.),
+                          MakeDoubleAccessor(&IrsAssistedSpectrumChannel::m_geometryCacheTolerance),
+                          MakeDoubleChecker<double>(0.))
+            .AddAttribute("ParallelGainThreads",
+                          "Number of threads used to evaluate the channel gain of the receivers "
+                          "of a transmission. Values lower than 2 disable parallel evaluation",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&IrsAssistedSpectrumChannel::SetParallelGainThreads,
+                                               &IrsAssistedSpectrumChannel::GetParallelGainThreads),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RangeCulling",
+                          "Skip the gain evaluation of receivers whose upper bound of the "
+                          "direct and reflected gain is beyond the maximum loss of the channel",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&IrsAssistedSpectrumChannel::m_rangeCulling),
+                          MakeBooleanChecker())
+            .AddAttribute("RangeCullingCellSize",
+                          "Side, in meters, of the cells of the grid used to group receivers "
+                          "before evaluating their gain upper bound",
+                          DoubleValue(100.),
+                          MakeDoubleAccessor(&IrsAssistedSpectrumChannel::m_rangeCullingCellSize),
+                          MakeDoubleChecker<double>(std::numeric_limits<double>::min()))
+            .AddAttribute("ChannelConditionModel",
+                          "Channel condition model used to determine LOS/NLOS conditions. "
+                          "A BuildingsChannelConditionModel is used if none is given",
+                          PointerValue(),
+                          MakePointerAccessor(&IrsAssistedSpectrumChannel::m_conditionModel),
+                          MakePointerChecker<ChannelConditionModel>())
+            .AddAttribute("ConditionCache",
+                          "Reuse the LOS condition of a pair of nodes until either node moves. "
+                          "Disable it for condition models that periodically redraw the "
+                          "condition of static nodes, the K-factors kept by the geometry cache "
+                          "are then recomputed from a new condition whenever they are used",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&IrsAssistedSpectrumChannel::m_conditionCacheEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("BatchTransmissions",
+                          "Defer the transmissions started at the same time instant to a single "
+                          "evaluation, which shares the geometry of the receivers among them. "
+                          "Transmissions are still propagated in the order they have been "
+                          "started",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&IrsAssistedSpectrumChannel::m_batchTransmissions),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -130,10 +249,68 @@ IrsAssistedSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
 
     NS_ASSERT(txParams->txPhy);
     NS_ASSERT(txParams->psd);
-    Ptr<SpectrumSignalParameters> txParamsTrace =
-        txParams->Copy(); // copy it since traced value cannot be const (because of potential
-                          // underlying DynamicCasts)
-    m_txSigParamsTrace(txParamsTrace);
+
+    if (!m_conditionModel)
+    {
+        m_conditionModel = CreateObject<BuildingsChannelConditionModel>();
+    }
+
+    if (!m_txSigParamsTrace.IsEmpty())
+    {
+        Ptr<SpectrumSignalParameters> txParamsTrace =
+            txParams->Copy(); // copy it since traced value cannot be const (because of potential
+                              // underlying DynamicCasts)
+        m_txSigParamsTrace(txParamsTrace);
+    }
+
+    if (m_batchTransmissions)
+    {
+        m_pendingTx.push_back(txParams);
+        if (!m_flushPending)
+        {
+            m_flushPending = true;
+            Simulator::ScheduleNow(&IrsAssistedSpectrumChannel::FlushTx, this);
+        }
+        return;
+    }
+
+    DoStartTx(txParams, GetIrsPositions());
+}
+
+void
+IrsAssistedSpectrumChannel::FlushTx()
+{
+    NS_LOG_FUNCTION(this << m_pendingTx.size());
+
+    m_flushPending = false;
+    const auto pendingTx = std::move(m_pendingTx);
+    m_pendingTx.clear();
+
+    // Nodes cannot move within the same time instant, thus the geometry validated by the first
+    // transmission of the batch holds for the following ones
+    m_batchId = ++m_batchCounter;
+    const auto irsPositions = GetIrsPositions();
+    for (const auto& txParams : pendingTx)
+        DoStartTx(txParams, irsPositions);
+    m_batchId = 0;
+}
+
+std::vector<Vector>
+IrsAssistedSpectrumChannel::GetIrsPositions()
+{
+    std::vector<Vector> irsPositions;
+    irsPositions.reserve(IrsList::GetN());
+    for (auto& irs : IrsList())
+        irsPositions.push_back(irs->GetDrone()->GetObject<MobilityModel>()->GetPosition());
+
+    return irsPositions;
+}
+
+void
+IrsAssistedSpectrumChannel::DoStartTx(Ptr<SpectrumSignalParameters> txParams,
+                                      const std::vector<Vector>& irsPositions)
+{
+    NS_LOG_FUNCTION(this << txParams);
 
     Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility();
     SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid();
@@ -171,212 +348,60 @@ IrsAssistedSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
         }
 
         // Speculative calc. section
-        double K_BG, F_BG, F_BRG, Irs2TxGain, Irs2RxGain, Tx2RxGain, Rx2TxGain;
-        std::vector<double> d_BR, d_BG, K_BR, K_BG_nu, K_BG_sigma, lambdav, d_RG_temp, etav_tmp,
-            K_RG_tmp, beta_BRG;
-        std::vector<Angles> a_BR, a_RG_temp;
-        std::vector<std::vector<double>> d_RG, etav, K_RG;
-        std::vector<std::vector<Angles>> a_RG;
-        Vector IrsPosition, TxPosition, RxPosition;
-        Ptr<BuildingsChannelConditionModel> condModel =
-            CreateObject<BuildingsChannelConditionModel>();
-
         const auto n_irs = IrsList::GetN();                 // Number of Irs
         const auto n_users = rxInfo.second.m_rxPhys.size(); // Number of receiving Phy layer
-        const double Kmin = std::pow(10., m_kmin / 10.);    // A1
-        const double Kmax = std::pow(10., m_kmax / 10.);
-        const double Knlos = std::pow(10., m_knlos / 10.);
-        const double A2 = std::log(std::pow(Kmax / Kmin, 2.)) / M_PI;
-
-        NodeToIrssDistance(txMobility, d_BR);
-        NodeToIrssAngles(txMobility, a_BR);
 
-        const auto f_l = convertedTxPowerSpectrum->GetSpectrumModel()->Begin()->fl;
-        const auto f_h = (--convertedTxPowerSpectrum->GetSpectrumModel()->End())->fh;
-        const double f_c = (f_h + f_l) / 2.0;
+        const auto& txGeometry = GetIrsGeometry(txMobility, irsPositions);
+        const auto& carrier = GetCarrierParams(convertedTxPowerSpectrum->GetSpectrumModel());
 
-        const double beta_BG = std::pow(SPEED_OF_LIGHT / f_c, 2.) / std::pow(4. * M_PI, 2.);
-        IrsBeta(beta_BRG, f_c);
+        GainInputs inputs;
+        inputs.culled.assign(n_users, false);
+        if (m_rangeCulling)
+        {
+            CullReceivers(txParams,
+                          rxInfo.second.m_rxPhys,
+                          irsPositions,
+                          txGeometry.distances,
+                          carrier.beta_BG,
+                          carrier.beta_BRG,
+                          inputs.culled);
+        }
 
         int i = 0;
         for (auto& rxPhy : rxInfo.second.m_rxPhys)
         {
-            RxPosition = rxPhy->GetMobility()->GetPosition();
-            TxPosition = txMobility->GetPosition();
-            auto rxParams = txParams->Copy();
-            rxParams->psd = convertedTxPowerSpectrum->Copy();
-            F_BG = 1.;
-
-            const auto channelCondBG =
-                condModel->GetChannelCondition(txMobility, rxPhy->GetMobility())->GetLosCondition();
-            if (channelCondBG == ChannelCondition::LosConditionValue::LOS)
-            {
-                K_BG = Kmin * exp(A2 * GetElevation(txMobility->GetPosition(),
-                                                    rxPhy->GetMobility()->GetPosition()));
-            }
-            else
-            {
-                K_BG = Knlos;
-            }
-            K_BG_nu.push_back(K_BG / (K_BG + 1.));
-            K_BG_sigma.push_back(std::sqrt(1. / (K_BG + 1.)));
-            d_BG.push_back(txMobility->GetDistanceFrom(rxPhy->GetMobility()));
-            NodeToIrssDistance(rxPhy->GetMobility(), d_RG_temp);
-            d_RG.push_back(d_RG_temp);
-            d_RG_temp.clear();
-            NodeToIrssAngles(rxPhy->GetMobility(), a_RG_temp);
-            a_RG.push_back(a_RG_temp);
-            a_RG_temp.clear();
-            etav_tmp.clear();
-            K_RG_tmp.clear();
-
-            auto rxAntenna = DynamicCast<AntennaModel>(rxPhy->GetAntenna());
-
-            for (uint32_t j = 0; j < n_irs; ++j)
-            {
-                F_BRG = 1;
-                IrsPosition =
-                    IrsList::Get(j)->GetDrone()->GetObject<MobilityModel>()->GetPosition();
-                const auto& txNodeIrsInclination =
-                    NodeToIrsAngles(txMobility, IrsList::Get(j)).GetInclination();
-                const auto& rxNodeIrsInclination =
-                    NodeToIrsAngles(rxPhy->GetMobility(), IrsList::Get(j)).GetInclination();
-                const auto& irsPowerState = IrsList::Get(j)->GetState();
-                const auto& irsDroneMM = IrsList::Get(j)->GetDrone()->GetObject<MobilityModel>();
-                const auto& chCondIrsRxNode =
-                    condModel->GetChannelCondition(irsDroneMM, rxPhy->GetMobility())
-                        ->GetLosCondition();
-                const auto& chCondTxNodeIrs =
-                    condModel->GetChannelCondition(txMobility, irsDroneMM)->GetLosCondition();
-
-                if (rxParams->txAntenna)
-                {
-                    Irs2TxGain = rxParams->txAntenna->GetGainDb(Angles(IrsPosition, TxPosition));
-                    if (std::isinf(Irs2TxGain))
-                        F_BRG *= 0.;
-                    else
-                        F_BRG *= std::pow(10., Irs2TxGain / 10.);
-                }
-                else
-                {
-                    NS_LOG_WARN("TX Antenna not found, isotropic antenna is used by dafualt");
-                    F_BRG *= 1.;
-                }
-
-                if (rxAntenna)
-                {
-                    Irs2RxGain = rxAntenna->GetGainDb(Angles(IrsPosition, RxPosition));
-                    if (std::isinf(Irs2RxGain))
-                        F_BRG *= 0.;
-                    else
-                        F_BRG *= std::pow(10., Irs2RxGain / 10.);
-                }
-                else
-                {
-                    NS_LOG_WARN("RX Antenna not found, isotropic antenna is used by dafualt");
-                    F_BRG *= 1.;
-                }
-
-                // Check if source and destination nodes are in LOS with the reflective face, if
-                // not, F_BRG=0 same logic applies even if the IRS is not ON.
-                if (txNodeIrsInclination > M_PI / 2. || rxNodeIrsInclination > M_PI / 2. ||
-                    irsPowerState != DronePeripheral::PeripheralState::ON)
-                {
-                    // Irss doesn't reflect by both faces and doesn't refract
-                    // Irs contribution is excluded
-                    F_BRG *= 0.;
-                }
-
-                if (!m_noIrsLink)
-                {
-                    etav_tmp.push_back(
-                        std::sqrt(beta_BRG[j] * std::pow(d_BR[j] * d_RG[i][j], -2.) * F_BRG));
-                }
-                else
-                {
-                    etav_tmp.push_back(0.);
-                }
-
-                if (chCondIrsRxNode == ChannelCondition::LosConditionValue::LOS)
-                {
-                    K_RG_tmp.push_back(Kmin * exp(A2 * (GetElevation(a_RG[i][j]))));
-                }
-                else
-                {
-                    K_RG_tmp.push_back(Knlos);
-                }
-
-                if (chCondTxNodeIrs == ChannelCondition::LosConditionValue::LOS)
-                {
-                    K_BR.push_back(Kmin * exp(A2 * (GetElevation(a_BR[j]))));
-                }
-                else
-                {
-                    K_BR.push_back(Knlos);
-                }
-            }
-            etav.push_back(etav_tmp);
-
-            if (rxParams->txAntenna)
-            {
-                Rx2TxGain = rxParams->txAntenna->GetGainDb(Angles(RxPosition, TxPosition));
-                if (std::isinf(Rx2TxGain))
-                    F_BG *= 0.;
-                else
-                    F_BG *= std::pow(10., Rx2TxGain / 10.);
-            }
-            else
-            {
-                NS_LOG_WARN("TX Antenna not found, isotropic antenna is used by dafualt");
-                F_BG *= 1.;
-            }
-
-            if (rxAntenna)
-            {
-                Tx2RxGain = rxAntenna->GetGainDb(Angles(TxPosition, RxPosition));
-                if (std::isinf(Tx2RxGain))
-                    F_BG *= 0.;
-                else
-                    F_BG *= std::pow(10., Tx2RxGain / 10.);
-            }
-            else
-            {
-                NS_LOG_WARN("RX Antenna not found, isotropic antenna is used by dafualt");
-                F_BG *= 1.;
-            }
-
-            if (!m_noDirectLink)
-            {
-                lambdav.push_back(std::sqrt(beta_BG * std::pow(d_BG[i], -m_alpha) * F_BG));
-            }
-            else
-            {
-                lambdav.push_back(0.);
-            }
-
-            K_RG.push_back(K_RG_tmp);
+            AddGainInputs(txParams,
+                          rxPhy->GetMobility(),
+                          DynamicCast<AntennaModel>(rxPhy->GetAntenna()),
+                          irsPositions,
+                          txGeometry,
+                          carrier,
+                          inputs.culled[i],
+                          inputs);
             ++i;
         }
 
-        const auto gain = GetGain(f_c,
+        const auto gain = GetGain(carrier.f_c,
                                   n_users,
                                   n_irs,
-                                  d_BG,
-                                  K_BR,
-                                  K_RG,
-                                  etav,
-                                  lambdav,
-                                  d_BR,
-                                  d_RG,
-                                  a_BR,
-                                  a_RG,
-                                  K_BG_nu,
-                                  K_BG_sigma);
+                                  inputs.d_BG,
+                                  txGeometry.kFactors,
+                                  inputs.K_RG,
+                                  inputs.etav,
+                                  inputs.lambdav,
+                                  txGeometry.distances,
+                                  inputs.d_RG,
+                                  txGeometry.angles,
+                                  inputs.a_RG,
+                                  inputs.K_BG_nu,
+                                  inputs.K_BG_sigma,
+                                  inputs.culled);
 
         //
-        int u = 0;
+        std::size_t u = 0;
         for (auto& rxPhy : rxInfo.second.m_rxPhys)
         {
+            const double rxGain = gain[u++];
             NS_ASSERT_MSG(rxPhy->GetRxSpectrumModel()->GetUid() == rxSpectrumModelUid,
                           "SpectrumModel change was not notified to IrsAssistedSpectrumChannel "
                           "(i.e., AddRx should be called again after model is changed)");
@@ -398,9 +423,6 @@ IrsAssistedSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                     }
                 }
 
-                NS_LOG_LOGIC("copying signal parameters " << txParams);
-                Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
-                rxParams->psd = convertedTxPowerSpectrum->Copy();
                 Time delay = MicroSeconds(0);
 
                 Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility();
@@ -409,8 +431,8 @@ IrsAssistedSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                 {
                     double pathLossDb = 0.;
 
-                    if (gain[u] > 0)
-                        pathLossDb = -10. * std::log10(gain[u]);
+                    if (rxGain > 0)
+                        pathLossDb = -10. * std::log10(rxGain);
                     else
                         pathLossDb = m_maxLossDb;
 
@@ -422,8 +444,20 @@ IrsAssistedSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                         // beyond range
                         continue;
                     }
+                }
 
-                    *(rxParams->psd) *= gain[u];
+                // Copies are made only for signals that are actually delivered. Copy() already
+                // duplicates the PSD, which is reused as it is when no conversion is needed.
+                NS_LOG_LOGIC("copying signal parameters " << txParams);
+                Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+                if (convertedTxPowerSpectrum != txParams->psd)
+                {
+                    rxParams->psd = convertedTxPowerSpectrum->Copy();
+                }
+
+                if (txMobility && receiverMobility)
+                {
+                    *(rxParams->psd) *= rxGain;
 
                     if (m_propagationDelay)
                     {
@@ -453,11 +487,650 @@ IrsAssistedSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                                         rxPhy);
                 }
             }
-            ++u;
         }
     }
 }
 
+void
+IrsAssistedSpectrumChannel::AddGainInputs(Ptr<const SpectrumSignalParameters> txParams,
+                                          Ptr<MobilityModel> rxMobility,
+                                          Ptr<AntennaModel> rxAntenna,
+                                          const std::vector<Vector>& irsPositions,
+                                          const IrsGeometry& txGeometry,
+                                          const CarrierParams& carrier,
+                                          const bool culled,
+                                          GainInputs& inputs)
+{
+    if (culled)
+    {
+        // The receiver cannot be reached, its placeholders are ignored by GetGain
+        inputs.d_BG.push_back(0.);
+        inputs.K_BG_nu.push_back(0.);
+        inputs.K_BG_sigma.push_back(0.);
+        inputs.d_RG.emplace_back();
+        inputs.a_RG.emplace_back();
+        inputs.K_RG.emplace_back();
+        inputs.etav.emplace_back();
+        inputs.lambdav.push_back(0.);
+        return;
+    }
+
+    double K_BG, F_BG, F_BRG, Irs2TxGain, Irs2RxGain, Tx2RxGain, Rx2TxGain;
+    std::vector<double> etav_tmp;
+    Vector IrsPosition, TxPosition, RxPosition;
+    Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility();
+    const auto n_irs = IrsList::GetN();
+    const auto& d_BR = txGeometry.distances;
+    const auto& a_BR = txGeometry.angles;
+    const auto& beta_BRG = carrier.beta_BRG;
+
+    RxPosition = rxMobility->GetPosition();
+    TxPosition = txMobility->GetPosition();
+    F_BG = 1.;
+
+    const auto& linkGeometry = GetLinkGeometry(txMobility, rxMobility);
+    K_BG = linkGeometry.kFactor;
+    inputs.K_BG_nu.push_back(K_BG / (K_BG + 1.));
+    inputs.K_BG_sigma.push_back(std::sqrt(1. / (K_BG + 1.)));
+    inputs.d_BG.push_back(linkGeometry.distance);
+
+    const auto& rxGeometry = GetIrsGeometry(rxMobility, irsPositions);
+    inputs.d_RG.push_back(rxGeometry.distances);
+    inputs.a_RG.push_back(rxGeometry.angles);
+    inputs.K_RG.push_back(rxGeometry.kFactors);
+    const auto& d_RG = inputs.d_RG.back();
+    const auto& a_RG = inputs.a_RG.back();
+
+    for (uint32_t j = 0; j < n_irs; ++j)
+    {
+        F_BRG = 1;
+        IrsPosition = irsPositions[j];
+        const auto& txNodeIrsInclination = a_BR[j].GetInclination();
+        const auto& rxNodeIrsInclination = a_RG[j].GetInclination();
+        const auto& irsPowerState = IrsList::Get(j)->GetState();
+
+        if (txParams->txAntenna)
+        {
+            Irs2TxGain = txParams->txAntenna->GetGainDb(Angles(IrsPosition, TxPosition));
+            if (std::isinf(Irs2TxGain))
+                F_BRG *= 0.;
+            else
+                F_BRG *= std::pow(10., Irs2TxGain / 10.);
+        }
+        else
+        {
+            NS_LOG_WARN("TX Antenna not found, isotropic antenna is used by dafualt");
+            F_BRG *= 1.;
+        }
+
+        if (rxAntenna)
+        {
+            Irs2RxGain = rxAntenna->GetGainDb(Angles(IrsPosition, RxPosition));
+            if (std::isinf(Irs2RxGain))
+                F_BRG *= 0.;
+            else
+                F_BRG *= std::pow(10., Irs2RxGain / 10.);
+        }
+        else
+        {
+            NS_LOG_WARN("RX Antenna not found, isotropic antenna is used by dafualt");
+            F_BRG *= 1.;
+        }
+
+        // Check if source and destination nodes are in LOS with the reflective face, if
+        // not, F_BRG=0 same logic applies even if the IRS is not ON.
+        if (txNodeIrsInclination > M_PI / 2. || rxNodeIrsInclination > M_PI / 2. ||
+            irsPowerState != DronePeripheral::PeripheralState::ON)
+        {
+            // Irss doesn't reflect by both faces and doesn't refract
+            // Irs contribution is excluded
+            F_BRG *= 0.;
+        }
+
+        if (!m_noIrsLink)
+        {
+            etav_tmp.push_back(std::sqrt(beta_BRG[j] * std::pow(d_BR[j] * d_RG[j], -2.) * F_BRG));
+        }
+        else
+        {
+            etav_tmp.push_back(0.);
+        }
+    }
+    inputs.etav.push_back(etav_tmp);
+
+    if (txParams->txAntenna)
+    {
+        Rx2TxGain = txParams->txAntenna->GetGainDb(Angles(RxPosition, TxPosition));
+        if (std::isinf(Rx2TxGain))
+            F_BG *= 0.;
+        else
+            F_BG *= std::pow(10., Rx2TxGain / 10.);
+    }
+    else
+    {
+        NS_LOG_WARN("TX Antenna not found, isotropic antenna is used by dafualt");
+        F_BG *= 1.;
+    }
+
+    if (rxAntenna)
+    {
+        Tx2RxGain = rxAntenna->GetGainDb(Angles(TxPosition, RxPosition));
+        if (std::isinf(Tx2RxGain))
+            F_BG *= 0.;
+        else
+            F_BG *= std::pow(10., Tx2RxGain / 10.);
+    }
+    else
+    {
+        NS_LOG_WARN("RX Antenna not found, isotropic antenna is used by dafualt");
+        F_BG *= 1.;
+    }
+
+    if (!m_noDirectLink)
+    {
+        inputs.lambdav.push_back(
+            std::sqrt(carrier.beta_BG * std::pow(inputs.d_BG.back(), -m_alpha) * F_BG));
+    }
+    else
+    {
+        inputs.lambdav.push_back(0.);
+    }
+}
+
+std::vector<double>
+IrsAssistedSpectrumChannel::GetGains(Ptr<const SpectrumSignalParameters> txParams,
+                                     const std::vector<Vector>& probes)
+{
+    NS_LOG_FUNCTION(this << txParams << probes.size());
+
+    NS_ASSERT(txParams->txPhy);
+    NS_ASSERT(txParams->psd);
+
+    if (!m_conditionModel)
+    {
+        m_conditionModel = CreateObject<BuildingsChannelConditionModel>();
+    }
+
+    // 3GPP condition models draw the condition once per pair of nodes, thus they would give every
+    // position the condition drawn for the first one
+    TypeId threeGpp;
+    const auto conditionTid = m_conditionModel->GetInstanceTypeId();
+    const bool isThreeGpp =
+        TypeId::LookupByNameFailSafe("ns3::ThreeGppChannelConditionModel", &threeGpp) &&
+        (conditionTid == threeGpp || conditionTid.IsChildOf(threeGpp));
+    NS_ABORT_MSG_IF(isThreeGpp, "3GPP channel condition models are not supported by GetGains.");
+
+    // A single probe is moved through the positions, so that the geometry of each of them is
+    // computed with the same code path of the receivers
+    if (!m_probe)
+    {
+        m_probe = CreateObject<ConstantPositionMobilityModel>();
+        m_probe->AggregateObject(CreateObject<MobilityBuildingInfo>());
+    }
+
+    const auto irsPositions = GetIrsPositions();
+    const auto& txGeometry = GetIrsGeometry(txParams->txPhy->GetMobility(), irsPositions);
+    const auto& carrier = GetCarrierParams(txParams->psd->GetSpectrumModel());
+
+    GainInputs inputs;
+    inputs.culled.assign(probes.size(), false);
+    for (const auto& position : probes)
+    {
+        m_probe->SetPosition(position);
+        AddGainInputs(txParams, m_probe, nullptr, irsPositions, txGeometry, carrier, false, inputs);
+    }
+
+    return GetGain(carrier.f_c,
+                   probes.size(),
+                   IrsList::GetN(),
+                   inputs.d_BG,
+                   txGeometry.kFactors,
+                   inputs.K_RG,
+                   inputs.etav,
+                   inputs.lambdav,
+                   txGeometry.distances,
+                   inputs.d_RG,
+                   txGeometry.angles,
+                   inputs.a_RG,
+                   inputs.K_BG_nu,
+                   inputs.K_BG_sigma,
+                   inputs.culled);
+}
+
+void
+IrsAssistedSpectrumChannel::CullReceivers(Ptr<const SpectrumSignalParameters> txParams,
+                                          const std::vector<Ptr<SpectrumPhy>>& rxPhys,
+                                          const std::vector<Vector>& irsPositions,
+                                          const std::vector<double>& d_BR,
+                                          const double beta_BG,
+                                          const std::vector<double>& beta_BRG,
+                                          std::vector<bool>& culled)
+{
+    NS_LOG_FUNCTION(this);
+
+    const double boundFactor = GetGainBoundFactor();
+    const double txGain = GetMaxAntennaGain(txParams->txAntenna);
+    if (boundFactor == 0. || m_alpha <= 0. || std::isinf(txGain))
+    {
+        NS_LOG_LOGIC("The gain of this transmission cannot be bounded, no receiver is culled");
+        return;
+    }
+
+    const double minGain = std::pow(10., -m_maxLossDb / 10.);
+    const auto txPosition = txParams->txPhy->GetMobility()->GetPosition();
+
+    std::vector<uint32_t> irsElements;
+    for (auto& irs : IrsList())
+    {
+        uint32_t n = 0;
+        for (const auto& patch : irs->GetPatchVector())
+            n += patch->GetSize().GetRowSize() * patch->GetSize().GetColSize();
+        irsElements.push_back(n);
+    }
+
+    // Upper bound of the gain for receivers that are at least d_BG away from the transmitter and
+    // d_RG away from each IRS, given the maximum gain of their antennas.
+    // Patch modules are bounded by eta * rows * cols since k-factor ratios and array factors
+    // are normalized, thus the mean received power is bounded by (A + lambda)^2 + B + lambda^2.
+    const auto gainBound = [&](const double d_BG, const std::vector<double>& d_RG, double rxGain) {
+        const double F = txGain * rxGain;
+        const double lambda =
+            m_noDirectLink ? 0. : std::sqrt(beta_BG * std::pow(d_BG, -m_alpha) * F);
+        double A = 0.;
+        double B = 0.;
+        for (std::size_t j = 0; !m_noIrsLink && j < d_RG.size(); ++j)
+        {
+            const double eta2 = beta_BRG[j] * std::pow(d_BR[j] * d_RG[j], -2.) * F;
+            A += std::sqrt(eta2) * irsElements[j];
+            B += eta2 * irsElements[j];
+        }
+        return boundFactor * (std::pow(A + lambda, 2.) + B + std::pow(lambda, 2.));
+    };
+
+    // Group receivers in a uniform grid, so that far away cells are discarded at once
+    typedef std::tuple<int64_t, int64_t, int64_t> CellIndex;
+    std::map<CellIndex, std::vector<std::size_t>> grid;
+    std::vector<Vector> rxPositions;
+    std::vector<double> rxGains;
+    for (const auto& rxPhy : rxPhys)
+    {
+        const auto pos = rxPhy->GetMobility()->GetPosition();
+        grid[{static_cast<int64_t>(std::floor(pos.x / m_rangeCullingCellSize)),
+              static_cast<int64_t>(std::floor(pos.y / m_rangeCullingCellSize)),
+              static_cast<int64_t>(std::floor(pos.z / m_rangeCullingCellSize))}]
+            .push_back(rxPositions.size());
+        rxPositions.push_back(pos);
+        rxGains.push_back(GetMaxAntennaGain(rxPhy->GetAntenna()));
+    }
+
+    // Distance between a point and the closest point of a cell
+    const auto cellDistance = [this](const Vector& p, const CellIndex& c) {
+        const auto axisDistance = [this](const double v, const int64_t i) {
+            const double lo = i * m_rangeCullingCellSize;
+            const double hi = lo + m_rangeCullingCellSize;
+            return std::max({lo - v, 0., v - hi});
+        };
+        return std::sqrt(std::pow(axisDistance(p.x, std::get<0>(c)), 2.) +
+                         std::pow(axisDistance(p.y, std::get<1>(c)), 2.) +
+                         std::pow(axisDistance(p.z, std::get<2>(c)), 2.));
+    };
+
+    std::vector<double> d_RG(irsPositions.size());
+    uint32_t nCulled = 0;
+    for (const auto& cell : grid)
+    {
+        double cellRxGain = 0.;
+        for (const auto i : cell.second)
+            cellRxGain = std::max(cellRxGain, rxGains[i]);
+
+        if (std::isinf(cellRxGain))
+        {
+            continue;
+        }
+
+        for (std::size_t j = 0; j < irsPositions.size(); ++j)
+            d_RG[j] = cellDistance(irsPositions[j], cell.first);
+
+        if (gainBound(cellDistance(txPosition, cell.first), d_RG, cellRxGain) <= minGain)
+        {
+            for (const auto i : cell.second)
+                culled[i] = true;
+            nCulled += cell.second.size();
+            continue;
+        }
+
+        for (const auto i : cell.second)
+        {
+            for (std::size_t j = 0; j < irsPositions.size(); ++j)
+                d_RG[j] = CalculateDistance(irsPositions[j], rxPositions[i]);
+
+            if (gainBound(CalculateDistance(txPosition, rxPositions[i]), d_RG, rxGains[i]) <=
+                minGain)
+            {
+                culled[i] = true;
+                ++nCulled;
+            }
+        }
+    }
+
+    NS_LOG_LOGIC("Culled " << nCulled << " receivers out of " << rxPhys.size());
+}
+
+double
+IrsAssistedSpectrumChannel::GetGainBoundFactor() const
+{
+    // When sqrt(2K) is above the threshold used by GetGain, the gain is always lower than the
+    // mean received power, as long as the inverse Q function does not approach the threshold
+    if (m_invqfunc >= 2.5)
+        return 0.;
+
+    // Otherwise, the ratio between gain and mean received power grows with K, hence it is
+    // bounded by its value on the threshold
+    const double K = std::pow(2.5848, 2.) / 2.;
+    return std::max(1., -std::log(1. - m_eps) * exp(K) / (K + 1.));
+}
+
+double
+IrsAssistedSpectrumChannel::GetMaxAntennaGain(Ptr<const Object> antenna)
+{
+    if (!antenna)
+        return 1.; // isotropic antenna
+
+    auto it = m_maxAntennaGains.find(PeekPointer(antenna));
+    if (it != m_maxAntennaGains.end())
+        return it->second;
+
+    double gainDb = std::numeric_limits<double>::infinity();
+    DoubleValue gain;
+    if (antenna->GetAttributeFailSafe("MaxGain", gain) ||
+        antenna->GetAttributeFailSafe("Gain", gain))
+    {
+        gainDb = gain.Get();
+    }
+    else if (DynamicCast<const ParabolicAntennaModel>(antenna))
+    {
+        gainDb = 0.;
+    }
+    else
+    {
+        NS_LOG_WARN("Cannot determine the maximum gain of antenna "
+                    << antenna->GetInstanceTypeId().GetName()
+                    << ", its receivers will not be culled");
+    }
+
+    const double linearGain = std::pow(10., gainDb / 10.);
+    m_maxAntennaGains.insert({PeekPointer(antenna), linearGain});
+    return linearGain;
+}
+
+void
+IrsAssistedSpectrumChannel::SetParallelGainThreads(const uint32_t n)
+{
+    NS_LOG_FUNCTION(this << n);
+    if (n > 1)
+        m_workerPool = std::make_unique<WorkerPool>(n);
+    else
+        m_workerPool.reset();
+}
+
+uint32_t
+IrsAssistedSpectrumChannel::GetParallelGainThreads() const
+{
+    return m_workerPool ? m_workerPool->GetN() : 1;
+}
+
+uint64_t
+IrsAssistedSpectrumChannel::GetGeometryCacheHits() const
+{
+    return m_geometryCacheHits;
+}
+
+uint64_t
+IrsAssistedSpectrumChannel::GetGeometryCacheMisses() const
+{
+    return m_geometryCacheMisses;
+}
+
+const IrsAssistedSpectrumChannel::KFactorParams&
+IrsAssistedSpectrumChannel::GetKFactorParams()
+{
+    if (m_kFactorParams.kminDb == m_kmin && m_kFactorParams.kmaxDb == m_kmax &&
+        m_kFactorParams.knlosDb == m_knlos)
+        return m_kFactorParams;
+
+    NS_LOG_LOGIC("K-factor attributes changed, invalidating the geometry caches");
+    m_irsGeometryCache.clear();
+    m_linkGeometryCache.clear();
+
+    const double Kmin = std::pow(10., m_kmin / 10.); // A1
+    const double Kmax = std::pow(10., m_kmax / 10.);
+    m_kFactorParams.kminDb = m_kmin;
+    m_kFactorParams.kmaxDb = m_kmax;
+    m_kFactorParams.knlosDb = m_knlos;
+    m_kFactorParams.Kmin = Kmin;
+    m_kFactorParams.Knlos = std::pow(10., m_knlos / 10.);
+    m_kFactorParams.A2 = std::log(std::pow(Kmax / Kmin, 2.)) / M_PI;
+
+    return m_kFactorParams;
+}
+
+const IrsAssistedSpectrumChannel::CarrierParams&
+IrsAssistedSpectrumChannel::GetCarrierParams(Ptr<const SpectrumModel> model)
+{
+    const auto version = IrsList::GetVersion();
+    auto it = m_carrierParams.find(model->GetUid());
+    if (it != m_carrierParams.end() && it->second.irsListVersion == version)
+    {
+        // PruX and PruY are attributes, thus they may change after the entry has been computed
+        bool valid = true;
+        std::size_t j = 0;
+        for (auto& irs : IrsList())
+        {
+            valid = valid && it->second.pruAreas[j] == irs->GetPruX() * irs->GetPruY();
+            ++j;
+        }
+        if (valid)
+            return it->second;
+    }
+
+    NS_LOG_LOGIC("computing carrier constants of spectrum model " << model->GetUid());
+    auto& entry = m_carrierParams[model->GetUid()];
+    const auto f_l = model->Begin()->fl;
+    const auto f_h = (--model->End())->fh;
+
+    entry.irsListVersion = version;
+    entry.pruAreas.clear();
+    for (auto& irs : IrsList())
+        entry.pruAreas.push_back(irs->GetPruX() * irs->GetPruY());
+    entry.f_c = (f_h + f_l) / 2.0;
+    entry.beta_BG = std::pow(SPEED_OF_LIGHT / entry.f_c, 2.) / std::pow(4. * M_PI, 2.);
+    entry.beta_BRG.clear();
+    IrsBeta(entry.beta_BRG, entry.f_c);
+
+    return entry;
+}
+
+void
+IrsAssistedSpectrumChannel::GetServedSteering(Ptr<Irs> irs,
+                                              Ptr<IrsPatch> patch,
+                                              double& phaseY,
+                                              double& phaseX,
+                                              double& distance)
+{
+    const auto servedNodes = patch->GetServedNodes();
+    const auto irsPosition = irs->GetDrone()->GetObject<MobilityModel>()->GetPosition();
+    const auto node1Position = servedNodes.first->GetObject<MobilityModel>()->GetPosition();
+    const auto node2Position = servedNodes.second->GetObject<MobilityModel>()->GetPosition();
+    const auto& cached = patch->GetSteering();
+
+    if (m_geometryCacheEnabled && cached.valid && IsStillValid(cached.irsPosition, irsPosition) &&
+        IsStillValid(cached.node1Position, node1Position) &&
+        IsStillValid(cached.node2Position, node2Position))
+    {
+        ++m_geometryCacheHits;
+        phaseY = cached.phaseY;
+        phaseX = cached.phaseX;
+        distance = cached.distance;
+        return;
+    }
+
+    ++m_geometryCacheMisses;
+    IrsPatch::Steering steering;
+    steering.irsPosition = irsPosition;
+    steering.node1Position = node1Position;
+    steering.node2Position = node2Position;
+    GetServedParam(irs, patch, steering.phaseY, steering.phaseX, steering.distance);
+    patch->SetSteering(steering);
+
+    phaseY = steering.phaseY;
+    phaseX = steering.phaseX;
+    distance = steering.distance;
+}
+
+bool
+IrsAssistedSpectrumChannel::IsStillValid(const Vector& cached, const Vector& current) const
+{
+    return CalculateDistance(cached, current) <= m_geometryCacheTolerance;
+}
+
+const IrsAssistedSpectrumChannel::IrsGeometry&
+IrsAssistedSpectrumChannel::GetIrsGeometry(Ptr<MobilityModel> node,
+                                           const std::vector<Vector>& irsPositions)
+{
+    // Drops the cached K-factors if the K-factor attributes changed
+    GetKFactorParams();
+    auto it = m_irsGeometryCache.find(PeekPointer(node));
+
+    if (m_batchId != 0 && it != m_irsGeometryCache.end() && it->second.batchId == m_batchId)
+    {
+        ++m_geometryCacheHits;
+        return it->second;
+    }
+
+    const auto nodePosition = node->GetPosition();
+    if (m_geometryCacheEnabled && it != m_irsGeometryCache.end() &&
+        it->second.irsPositions.size() == irsPositions.size() &&
+        IsStillValid(it->second.nodePosition, nodePosition))
+    {
+        bool valid = true;
+        for (std::size_t j = 0; valid && j < irsPositions.size(); ++j)
+            valid = IsStillValid(it->second.irsPositions[j], irsPositions[j]);
+
+        if (valid)
+        {
+            ++m_geometryCacheHits;
+            it->second.batchId = m_batchId;
+            // Without the condition cache, the condition of static nodes may change as well
+            if (!m_conditionCacheEnabled)
+                SetIrsKFactors(node, it->second);
+            return it->second;
+        }
+    }
+
+    ++m_geometryCacheMisses;
+
+    auto& entry = m_irsGeometryCache[PeekPointer(node)];
+    entry.batchId = m_batchId;
+    entry.nodePosition = nodePosition;
+    entry.irsPositions = irsPositions;
+    entry.distances.clear();
+    entry.angles.clear();
+    NodeToIrssDistance(node, entry.distances);
+    NodeToIrssAngles(node, entry.angles);
+    SetIrsKFactors(node, entry);
+
+    return entry;
+}
+
+void
+IrsAssistedSpectrumChannel::SetIrsKFactors(Ptr<MobilityModel> node, IrsGeometry& entry)
+{
+    const auto& kp = GetKFactorParams();
+    entry.kFactors.clear();
+
+    std::size_t j = 0;
+    for (auto& irs : IrsList())
+    {
+        const auto irsDroneMM = irs->GetDrone()->GetObject<MobilityModel>();
+        const auto chCond = GetLosCondition(node, irsDroneMM);
+        if (chCond == ChannelCondition::LosConditionValue::LOS)
+            entry.kFactors.push_back(kp.Kmin * exp(kp.A2 * (GetElevation(entry.angles[j]))));
+        else
+            entry.kFactors.push_back(kp.Knlos);
+        ++j;
+    }
+}
+
+const IrsAssistedSpectrumChannel::LinkGeometry&
+IrsAssistedSpectrumChannel::GetLinkGeometry(Ptr<MobilityModel> tx, Ptr<MobilityModel> rx)
+{
+    // Drops the cached K-factors if the K-factor attributes changed
+    GetKFactorParams();
+    const auto txPosition = tx->GetPosition();
+    const auto rxPosition = rx->GetPosition();
+    const auto key = std::make_pair(PeekPointer(tx), PeekPointer(rx));
+    auto it = m_linkGeometryCache.find(key);
+
+    if (m_geometryCacheEnabled && it != m_linkGeometryCache.end() &&
+        IsStillValid(it->second.txPosition, txPosition) &&
+        IsStillValid(it->second.rxPosition, rxPosition))
+    {
+        ++m_geometryCacheHits;
+        // Without the condition cache, the condition of static nodes may change as well
+        if (!m_conditionCacheEnabled)
+            SetLinkKFactor(tx, rx, it->second);
+        return it->second;
+    }
+
+    ++m_geometryCacheMisses;
+
+    auto& entry = m_linkGeometryCache[key];
+    entry.txPosition = txPosition;
+    entry.rxPosition = rxPosition;
+    entry.distance = tx->GetDistanceFrom(rx);
+    SetLinkKFactor(tx, rx, entry);
+
+    return entry;
+}
+
+void
+IrsAssistedSpectrumChannel::SetLinkKFactor(Ptr<MobilityModel> tx,
+                                           Ptr<MobilityModel> rx,
+                                           LinkGeometry& entry)
+{
+    const auto& kp = GetKFactorParams();
+    const auto chCond = GetLosCondition(tx, rx);
+    if (chCond == ChannelCondition::LosConditionValue::LOS)
+        entry.kFactor = kp.Kmin * exp(kp.A2 * GetElevation(entry.txPosition, entry.rxPosition));
+    else
+        entry.kFactor = kp.Knlos;
+}
+
+ChannelCondition::LosConditionValue
+IrsAssistedSpectrumChannel::GetLosCondition(Ptr<MobilityModel> a, Ptr<MobilityModel> b)
+{
+    if (!m_conditionCacheEnabled)
+        return m_conditionModel->GetChannelCondition(a, b)->GetLosCondition();
+
+    // Channel condition models are reciprocal, thus the pair is stored in a canonical order
+    if (PeekPointer(b) < PeekPointer(a))
+        std::swap(a, b);
+
+    const auto aPosition = a->GetPosition();
+    const auto bPosition = b->GetPosition();
+    const auto key = std::make_pair(PeekPointer(a), PeekPointer(b));
+    auto it = m_losCache.find(key);
+
+    if (it == m_losCache.end() || CalculateDistance(it->second.aPosition, aPosition) > 0. ||
+        CalculateDistance(it->second.bPosition, bPosition) > 0.)
+    {
+        const auto los = m_conditionModel->GetChannelCondition(a, b)->GetLosCondition();
+        it = m_losCache.insert_or_assign(key, LosCondition{aPosition, bPosition, los}).first;
+    }
+
+    return it->second.los;
+}
+
 std::vector<double>
 IrsAssistedSpectrumChannel::GetGain(const double f_c,
                                     const int n_users,
@@ -472,89 +1145,101 @@ IrsAssistedSpectrumChannel::GetGain(const double f_c,
                                     const std::vector<Angles>& a_BR,
                                     const std::vector<std::vector<Angles>>& a_RG,
                                     const std::vector<double>& K_BG_nu,
-                                    const std::vector<double>& K_BG_sigma)
+                                    const std::vector<double>& K_BG_sigma,
+                                    const std::vector<bool>& culled)
 {
-    double nu_BRG, sig_BRG, K, sigma;
-    std::vector<double> phases_tmp, modules_tmp, gain;
-    std::vector<std::vector<double>> phases, modules;
-
-    double cos_BR = 0.;
-    double sin_BR = 0.;
-    double cos_RG = 0.;
-    double sin_RG = 0.;
+    if (n_users == 0)
+        return {};
 
-    for (int u = 0; u < n_users; ++u)
+    // Steering parameters of patches do not depend on the receiver, thus they are collected once
+    // and in the simulator thread, since they require access to ns-3 objects
+    std::vector<IrsParams> irsParams(n_irs);
+    for (int d = 0; d < n_irs; ++d)
     {
-        nu_BRG = 0.;
-        sig_BRG = 0.;
+        const auto irs = IrsList::Get(d);
+        irsParams[d].d_r = irs->GetPruY();
+        irsParams[d].d_c = irs->GetPruX();
 
-        phases.clear();
-        modules.clear();
-        for (int d = 0; d < n_irs; ++d)
+        for (const auto& patch : irs->GetPatchVector())
         {
-            const auto K_BRG_nu =
-                std::sqrt(K_BR[d] * K_RG[u][d] / (K_BR[d] + 1.) / (K_RG[u][d] + 1.));
-            const auto K_BRG_sigma =
-                std::sqrt((K_BR[d] + K_RG[u][d]) / (K_BR[d] + 1) / (K_RG[u][d] + 1.));
-            // For each patch
-            const auto irs = IrsList::Get(d);
-            const auto d_r = irs->GetPruY();
-            const auto d_c = irs->GetPruX();
-            const auto patches = irs->GetPatchVector();
-
-            phases_tmp.clear();
-            modules_tmp.clear();
-            const auto P = patches.size();
-            for (std::size_t p = 0; p < P; ++p)
+            double phaseX, phaseY, distance;
+            if (patch->IsServing())
+            {
+                GetServedSteering(irs, patch, phaseX, phaseY, distance);
+            }
+            else
             {
-                modules_tmp.push_back(etav[u][d] * K_BRG_nu);
-                double phaseY, phaseX, distance;
-                if (patches[p]->IsServing())
+                double theta_r, phi_r, z;
+                const auto theta_o = a_BR[d].GetInclination();
+                const auto phi_o = a_BR[d].GetAzimuth();
+                phaseX = patch->GetPhaseX();
+                phaseY = patch->GetPhaseY();
+                // Computation of Irs-Ground distance following the angle of reflection
+                if (phaseX == 0)
                 {
-                    GetServedParam(irs, patches[p], phaseX, phaseY, distance);
+                    theta_r = theta_o;
                 }
                 else
                 {
-                    double theta_r, phi_r, z;
-                    const auto theta_o = a_BR[d].GetInclination();
-                    const auto phi_o = a_BR[d].GetAzimuth();
-                    phaseX = patches[p]->GetPhaseX();
-                    phaseY = patches[p]->GetPhaseY();
-                    // Computation of Irs-Ground distance following the angle of reflection
-                    if (phaseX == 0)
-                    {
-                        theta_r = theta_o;
-                    }
-                    else
-                    {
-                        if (!std::isnan(phi_o))
-                        {
-                            phi_r = std::atan(phaseY / phaseX - std::tan(phi_o));
-                            theta_r = std::asin((phaseY - std::sin(theta_o) * std::sin(phi_o)) /
-                                                std::sin(phi_r));
-                        }
-                        else
-                        {
-                            phi_r = std::atan(phaseY / phaseX);
-                            theta_r = std::asin(phaseY - std::sin(theta_o) / std::sin(phi_r));
-                        }
-                    }
-                    if (!std::isnan(theta_r))
+                    if (!std::isnan(phi_o))
                     {
-                        z = irs->GetDrone()->GetObject<MobilityModel>()->GetPosition().z;
-                        distance =
-                            std::sqrt(std::pow(z, 2.) + std::pow(z * std::tan(theta_r), 2.)) +
-                            d_BR[d];
+                        phi_r = std::atan(phaseY / phaseX - std::tan(phi_o));
+                        theta_r = std::asin((phaseY - std::sin(theta_o) * std::sin(phi_o)) /
+                                            std::sin(phi_r));
                     }
                     else
                     {
-                        NS_ABORT_MSG("The values of phaseX and phaseY are not valid.");
+                        phi_r = std::atan(phaseY / phaseX);
+                        theta_r = std::asin(phaseY - std::sin(theta_o) / std::sin(phi_r));
                     }
                 }
-                cos_BR = 0.;
-                sin_BR = 0.;
-                cos_RG = 0.;
-                sin_RG = 0.;
+                if (!std::isnan(theta_r))
+                {
+                    z = irs->GetDrone()->GetObject<MobilityModel>()->GetPosition().z;
+                    distance =
+                        std::sqrt(std::pow(z, 2.) + std::pow(z * std::tan(theta_r), 2.)) + d_BR[d];
+                }
+                else
+                {
+                    NS_ABORT_MSG("The values of phaseX and phaseY are not valid.");
+                }
+            }
+            irsParams[d].patches.Add(patch->GetSize().GetRowSize(),
+                                     patch->GetSize().GetColSize(),
+                                     phaseX,
+                                     phaseY,
+                                     distance);
+        }
+    }
+
+    std::vector<double> gain(n_users, 0.);
+    const auto kernel = IrsArrayFactor::Resolve(m_arrayFactorKernel);
+
+    // Evaluate the gain of a range of users. It only reads plain data, so that ranges can be
+    // evaluated concurrently and each user gets exactly the same result of a serial evaluation.
+    const auto evaluateUsers = [&](std::size_t begin, std::size_t end) {
+        double nu_BRG, sig_BRG, K, sigma;
+        std::vector<std::vector<double>> phases(n_irs), modules(n_irs);
+
+        for (std::size_t u = begin; u < end; ++u)
+        {
+            if (culled[u])
+                continue;
+
+            sig_BRG = 0.;
+
+            for (int d = 0; d < n_irs; ++d)
+            {
+                const auto K_BRG_nu =
+                    std::sqrt(K_BR[d] * K_RG[u][d] / (K_BR[d] + 1.) / (K_RG[u][d] + 1.));
+                const auto K_BRG_sigma =
+                    std::sqrt((K_BR[d] + K_RG[u][d]) / (K_BR[d] + 1) / (K_RG[u][d] + 1.));
+                const auto& patches = irsParams[d].patches;
+
+                double cos_BR = 0.;
+                double sin_BR = 0.;
+                double cos_RG = 0.;
+                double sin_RG = 0.;
 
                 if (!std::isnan(a_BR[d].GetAzimuth()))
                 {
@@ -568,107 +1253,172 @@ IrsAssistedSpectrumChannel::GetGain(const double f_c,
                     sin_RG = std::sin(a_RG[u][d].GetAzimuth());
                 }
 
-                const auto phi_x = d_c * (std::sin(a_BR[d].GetInclination()) * cos_BR +
-                                          std::sin(a_RG[u][d].GetInclination()) * cos_RG - phaseX);
-                const auto phi_y = d_r * (std::sin(a_BR[d].GetInclination()) * sin_BR +
-                                          std::sin(a_RG[u][d].GetInclination()) * sin_RG - phaseY);
-
-                auto pigr = 2. * M_PI;
-                if (modf(phi_x * M_PI * f_c / SPEED_OF_LIGHT, &pigr) ==
-                    0.) // if it is multiple of pi denominator is 0
-                    modules_tmp[p] = modules_tmp[p] *
-                                     patches[p]->GetSize().GetColSize(); // Paper: Formula 19 (Chi)
-                else
-                    modules_tmp[p] =
-                        modules_tmp[p] *
-                        std::sin(patches[p]->GetSize().GetColSize() * phi_x * M_PI * f_c /
-                                 SPEED_OF_LIGHT) /
-                        std::sin(phi_x * M_PI * f_c / SPEED_OF_LIGHT); // Paper: Formula 19 (Chi)
-
-                if (modf(phi_y * M_PI * f_c / SPEED_OF_LIGHT, &pigr) ==
-                    0) // if it is multiple of pi denominator is 0
-                {
-                    modules_tmp[p] = modules_tmp[p] *
-                                     patches[p]->GetSize().GetRowSize(); // Paper: Formula 19 (Chi)
-                }
-                else
-                    modules_tmp[p] =
-                        modules_tmp[p] *
-                        std::sin(patches[p]->GetSize().GetRowSize() * phi_y * M_PI * f_c /
-                                 SPEED_OF_LIGHT) /
-                        std::sin(phi_y * M_PI * f_c / SPEED_OF_LIGHT); // Paper: Formula 19 (Chi)
-
-                phases_tmp.push_back(
-                    -2. * M_PI * f_c / SPEED_OF_LIGHT *
-                    (d_BR[d] + d_RG[u][d] - distance)); // Paper: Formula 19 (Omega)
+                IrsArrayFactor::Params params;
+                params.k = M_PI * f_c / SPEED_OF_LIGHT;
+                params.d_c = irsParams[d].d_c;
+                params.d_r = irsParams[d].d_r;
+                params.baseX = std::sin(a_BR[d].GetInclination()) * cos_BR +
+                               std::sin(a_RG[u][d].GetInclination()) * cos_RG;
+                params.baseY = std::sin(a_BR[d].GetInclination()) * sin_BR +
+                               std::sin(a_RG[u][d].GetInclination()) * sin_RG;
+                params.scale = etav[u][d] * K_BRG_nu;
+                params.pathLength = d_BR[d] + d_RG[u][d];
+
+                modules[d].resize(patches.GetN());
+                phases[d].resize(patches.GetN());
+                IrsArrayFactor::Evaluate(kernel,
+                                         patches,
+                                         params,
+                                         modules[d].data(),
+                                         phases[d].data());
+
+                sig_BRG +=
+                    std::pow(etav[u][d], 2.) * std::pow(K_BRG_sigma, 2.) * patches.nPrus;
             }
-            modules.push_back(modules_tmp);
-            phases.push_back(phases_tmp);
 
-            for (std::size_t p = 0; p < P; ++p)
+            const double directNu = lambdav[u] * K_BG_nu[u];
+            const double directPhase = 2. * M_PI * f_c / SPEED_OF_LIGHT * d_BG[u];
+            switch (m_gainEngine)
             {
-                for (int d1 = 0; d1 <= d; ++d1)
-                {
-                    for (std::size_t p1 = 0; p1 < P; ++p1)
-                    {
-                        if (d == d1)
-                        {
-                            if (p1 <= p)
-                                p1 = p + 1;
-                            if (p == P - 1)
-                                break;
-                        }
-                        nu_BRG += 2. * std::abs(modules[d][p]) * std::abs(modules[d1][p1]) *
-                                  std::cos(phases[d][p] - phases[d1][p1]);
-                    }
-                }
-                nu_BRG += std::pow(modules[d][p], 2.);
-
-                switch (m_multipathType)
-                {
-                case MultipathInterferenceType::SIMULATED:
-                    nu_BRG += 2. * std::abs(modules[d][p]) * lambdav[u] * K_BG_nu[u] *
-                              std::cos(phases[d][p] + 2. * M_PI * f_c / SPEED_OF_LIGHT * d_BG[u]);
-
-                    break;
-                case MultipathInterferenceType::CONSTRUCTIVE:
-                    nu_BRG += 2. * std::abs(modules[d][p]) * lambdav[u] * K_BG_nu[u];
-                    break;
-                case MultipathInterferenceType::DESTRUCTIVE:
-                    nu_BRG -= 2. * std::abs(modules[d][p]) * lambdav[u] * K_BG_nu[u];
-                    break;
-                }
+            case IrsGainEngineType::PHASOR:
+                nu_BRG = GetPhasorNu(modules, phases, directNu, directPhase);
+                break;
+            case IrsGainEngineType::PAIRWISE:
+                nu_BRG = GetPairwiseNu(modules, phases, directNu, directPhase);
+                break;
+            case IrsGainEngineType::CROSS_CHECK: {
+                nu_BRG = GetPhasorNu(modules, phases, directNu, directPhase);
+                const double nuPairwise = GetPairwiseNu(modules, phases, directNu, directPhase);
+
+                // Normalize the disagreement to the power of the incoherent sum, which bounds
+                // every term of both engines and avoids false positives on destructive
+                // interference
+                double scale = directNu;
+                for (const auto& irsModules : modules)
+                    for (const auto& m : irsModules)
+                        scale += std::abs(m);
+                scale = std::pow(scale, 2.);
+
+                NS_ABORT_MSG_IF(std::abs(nu_BRG - nuPairwise) > m_crossCheckTolerance * scale,
+                                "IRS gain engines disagree for user "
+                                    << u << ": phasor=" << nu_BRG << " pairwise=" << nuPairwise
+                                    << " scale=" << scale);
+                break;
+            }
+            }
+            sig_BRG += std::pow(lambdav[u] * K_BG_sigma[u], 2.);
 
-                sig_BRG += std::pow(etav[u][d], 2.) * std::pow(K_BRG_sigma, 2.) *
-                           patches[p]->GetSize().GetRowSize() * patches[p]->GetSize().GetColSize();
+            if (sig_BRG == 0. || nu_BRG == 0.)
+            {
+                gain[u] = 0.;
+            }
+            else
+            {
+                K = nu_BRG / sig_BRG;
+
+                sigma = nu_BRG + sig_BRG;
+                if (std::sqrt(2. * K) > 2.5848)
+                    gain[u] = std::pow(std::sqrt(2. * K) +
+                                           0.5 / m_invqfunc *
+                                               std::log(std::sqrt(2. * K) /
+                                                        (std::sqrt(2. * K) - m_invqfunc)) -
+                                           m_invqfunc,
+                                       2.) /
+                              (2. * (K + 1.) / sigma);
+                else
+                    gain[u] = std::pow(std::sqrt(-2. * std::log(1. - m_eps)) * exp(K / 2.), 2.) /
+                              (2. * (K + 1.) / sigma);
             }
         }
-        nu_BRG += std::pow(lambdav[u] * K_BG_nu[u], 2.);
-        sig_BRG += std::pow(lambdav[u] * K_BG_sigma[u], 2.);
+    };
+
+    if (m_workerPool)
+        m_workerPool->ParallelFor(n_users, evaluateUsers);
+    else
+        evaluateUsers(0, n_users);
+
+    return gain;
+}
 
-        if (sig_BRG == 0. || nu_BRG == 0.)
+double
+IrsAssistedSpectrumChannel::GetPhasorNu(const std::vector<std::vector<double>>& modules,
+                                        const std::vector<std::vector<double>>& phases,
+                                        const double directNu,
+                                        const double directPhase) const
+{
+    // nu = |sum_p |m_p| e^(j omega_p) + directNu e^(-j directPhase)|^2, which expands exactly into
+    // the pairwise sum of GetPairwiseNu
+    std::complex<double> field{0., 0.};
+    double incoherent = 0.;
+    for (std::size_t d = 0; d < modules.size(); ++d)
+    {
+        for (std::size_t p = 0; p < modules[d].size(); ++p)
         {
-            gain.push_back(0.);
+            const double m = std::abs(modules[d][p]);
+            field += std::polar(m, phases[d][p]);
+            incoherent += m;
         }
-        else
+    }
+
+    double nu = 0.;
+    switch (m_multipathType)
+    {
+    case MultipathInterferenceType::SIMULATED:
+        nu = std::norm(field + std::polar(directNu, -directPhase));
+        break;
+    case MultipathInterferenceType::CONSTRUCTIVE:
+        nu = std::norm(field) + 2. * incoherent * directNu + std::pow(directNu, 2.);
+        break;
+    case MultipathInterferenceType::DESTRUCTIVE:
+        nu = std::norm(field) - 2. * incoherent * directNu + std::pow(directNu, 2.);
+        break;
+    }
+
+    return nu;
+}
+
+double
+IrsAssistedSpectrumChannel::GetPairwiseNu(const std::vector<std::vector<double>>& modules,
+                                          const std::vector<std::vector<double>>& phases,
+                                          const double directNu,
+                                          const double directPhase) const
+{
+    double nu = 0.;
+    for (std::size_t d = 0; d < modules.size(); ++d)
+    {
+        const auto P = modules[d].size();
+        for (std::size_t p = 0; p < P; ++p)
         {
-            K = nu_BRG / sig_BRG;
-
-            sigma = nu_BRG + sig_BRG;
-            if (std::sqrt(2. * K) > 2.5848)
-                gain.push_back(std::pow(std::sqrt(2. * K) +
-                                            0.5 / m_invqfunc *
-                                                std::log(std::sqrt(2. * K) /
-                                                         (std::sqrt(2. * K) - m_invqfunc)) -
-                                            m_invqfunc,
-                                        2.) /
-                               (2. * (K + 1.) / sigma));
-            else
-                gain.push_back(std::pow(std::sqrt(-2. * std::log(1. - m_eps)) * exp(K / 2.), 2.) /
-                               (2. * (K + 1.) / sigma));
+            // Each pair is summed once: the following patches of the same IRS, and every patch of
+            // the preceding IRSs, which may have a different number of patches
+            for (std::size_t d1 = 0; d1 <= d; ++d1)
+            {
+                for (std::size_t p1 = (d1 == d) ? p + 1 : 0; p1 < modules[d1].size(); ++p1)
+                {
+                    nu += 2. * std::abs(modules[d][p]) * std::abs(modules[d1][p1]) *
+                          std::cos(phases[d][p] - phases[d1][p1]);
+                }
+            }
+            nu += std::pow(modules[d][p], 2.);
+
+            switch (m_multipathType)
+            {
+            case MultipathInterferenceType::SIMULATED:
+                nu += 2. * std::abs(modules[d][p]) * directNu *
+                      std::cos(phases[d][p] + directPhase);
+                break;
+            case MultipathInterferenceType::CONSTRUCTIVE:
+                nu += 2. * std::abs(modules[d][p]) * directNu;
+                break;
+            case MultipathInterferenceType::DESTRUCTIVE:
+                nu -= 2. * std::abs(modules[d][p]) * directNu;
+                break;
+            }
         }
     }
-    return gain;
+    nu += std::pow(directNu, 2.);
+
+    return nu;
 }
 
 void
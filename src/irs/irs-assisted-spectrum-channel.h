@@ -20,9 +20,18 @@
 #ifndef IRS_ASSISTED_SPECTRUM_CHANNEL_H
 #define IRS_ASSISTED_SPECTRUM_CHANNEL_H
 
+#include "irs-array-factor.h"
 #include "irs.h"
 
+#include <ns3/angles.h>
+#include <ns3/channel-condition-model.h>
 #include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/worker-pool.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -34,6 +43,13 @@ enum MultipathInterferenceType
     CONSTRUCTIVE = 1
 };
 
+enum IrsGainEngineType
+{
+    PHASOR = 0,     // Coherent phasor sum of the reflected field, O(IRS x patches)
+    PAIRWISE = 1,   // Legacy pairwise accumulation of patch contributions, O((IRS x patches)^2)
+    CROSS_CHECK = 2 // Evaluate both engines and abort if they disagree
+};
+
 /**
  * \ingroup irs
  *
@@ -52,12 +68,275 @@ class IrsAssistedSpectrumChannel : public MultiModelSpectrumChannel
      */
     static TypeId GetTypeId(void);
 
+    IrsAssistedSpectrumChannel();
+
     virtual void StartTx(Ptr<SpectrumSignalParameters> params);
 
+    /**
+     * \returns the number of geometry lookups served by the geometry cache.
+     */
+    uint64_t GetGeometryCacheHits() const;
+
+    /**
+     * \returns the number of geometry lookups that required a new computation.
+     */
+    uint64_t GetGeometryCacheMisses() const;
+
+    /**
+     * \brief Set the number of threads used to evaluate the channel gain of receivers.
+     *
+     * \param n the number of threads. Values lower than 2 disable parallel evaluation.
+     */
+    void SetParallelGainThreads(const uint32_t n);
+
+    /**
+     * \returns the number of threads used to evaluate the channel gain of receivers.
+     */
+    uint32_t GetParallelGainThreads() const;
+
+    /**
+     * \brief Evaluate the linear channel gain from a transmitter to a set of positions, as it
+     * would be applied to receivers with an isotropic antenna placed there, including the paths
+     * reflected by the IRSs. No SpectrumPhy is involved, thus the gains can be queried for many
+     * positions at once, e.g., to build coverage maps.
+     *
+     * The positions are not attached to any Node, hence 3GPP channel condition models, which
+     * cache the condition per pair of nodes, are not supported.
+     *
+     * \param txParams the parameters of a transmission, whose spectrum model sets the carrier.
+     * \param probes the positions to evaluate.
+     * \return the gain at each position.
+     */
+    std::vector<double> GetGains(Ptr<const SpectrumSignalParameters> txParams,
+                                 const std::vector<Vector>& probes);
+
   protected:
     virtual void DoDispose();
 
   private:
+    /**
+     * \brief Propagate a transmission to every receiver.
+     *
+     * \param txParams the parameters of the transmission.
+     * \param irsPositions current positions of the IRSs.
+     */
+    void DoStartTx(Ptr<SpectrumSignalParameters> txParams, const std::vector<Vector>& irsPositions);
+
+    /**
+     * \brief Propagate the transmissions deferred by StartTx at the current time, in the order
+     * they have been started, sharing the geometry of their receivers.
+     */
+    void FlushTx();
+
+    /**
+     * \brief Collect the current positions of the IRSs.
+     *
+     * \return the position of each IRS in the IrsList.
+     */
+    static std::vector<Vector> GetIrsPositions();
+
+    /**
+     * \brief Geometry of a node with respect to every IRS in the IrsList.
+     */
+    struct IrsGeometry
+    {
+        Vector nodePosition;              //!< Node position used to compute this entry
+        std::vector<Vector> irsPositions; //!< IRS positions used to compute this entry
+        std::vector<double> distances;    //!< Distance between the node and each IRS
+        std::vector<Angles> angles;       //!< Angles of the node in the reference frame of each IRS
+        std::vector<double> kFactors;     //!< K-factor of the link between the node and each IRS
+        uint64_t batchId{0};              //!< Batch of transmissions that last validated it
+    };
+
+    /**
+     * \brief Geometry of the direct link between a transmitter and a receiver.
+     */
+    struct LinkGeometry
+    {
+        Vector txPosition; //!< Transmitter position used to compute this entry
+        Vector rxPosition; //!< Receiver position used to compute this entry
+        double distance;   //!< Distance between transmitter and receiver
+        double kFactor;    //!< K-factor of the direct link
+    };
+
+    /**
+     * \brief Linear K-factor parameters, derived from the KMin, KMax and KNlos attributes.
+     */
+    struct KFactorParams
+    {
+        double kminDb;  //!< KMin attribute used to compute this entry [dB]
+        double kmaxDb;  //!< KMax attribute used to compute this entry [dB]
+        double knlosDb; //!< KNlos attribute used to compute this entry [dB]
+        double Kmin;    //!< Linear minimum K-factor (A1)
+        double Knlos;   //!< Linear NLOS K-factor
+        double A2;      //!< Slope of the K-factor with respect to the elevation angle
+    };
+
+    /**
+     * \brief Constants of a receiving spectrum model, independent from the nodes positions.
+     */
+    struct CarrierParams
+    {
+        uint64_t irsListVersion;      //!< IrsList version used to compute this entry
+        std::vector<double> pruAreas; //!< PRU area of each IRS used to compute this entry
+        double f_c;                   //!< Carrier frequency
+        double beta_BG;               //!< Free space gain factor of the direct link
+        std::vector<double> beta_BRG; //!< Free space gain factor of the link through each IRS
+    };
+
+    /**
+     * \brief Parameters of an IRS needed to evaluate its reflected contribution.
+     */
+    struct IrsParams
+    {
+        double d_r;            //!< Y-side dimension of a PRU
+        double d_c;            //!< X-side dimension of a PRU
+        IrsPatchArray patches; //!< Steering parameters of each patch
+    };
+
+    /**
+     * \brief Per-receiver inputs of GetGain, for a given transmitter.
+     */
+    struct GainInputs
+    {
+        std::vector<double> d_BG;              //!< Distance between transmitter and receiver
+        std::vector<double> K_BG_nu;           //!< nu component of the direct link
+        std::vector<double> K_BG_sigma;        //!< sigma component of the direct link
+        std::vector<double> lambdav;           //!< lambda component of the direct link
+        std::vector<std::vector<double>> d_RG; //!< Distances between IRSs and receiver
+        std::vector<std::vector<Angles>> a_RG; //!< Angles between IRSs and receiver
+        std::vector<std::vector<double>> K_RG; //!< K-factors between IRSs and receiver
+        std::vector<std::vector<double>> etav; //!< eta component of the link through each IRS
+        std::vector<bool> culled;              //!< Whether the receiver has been culled
+    };
+
+    /**
+     * \brief Channel condition of a pair of nodes, evaluated at the given positions.
+     */
+    struct LosCondition
+    {
+        Vector aPosition;                       //!< Position of the first node
+        Vector bPosition;                       //!< Position of the second node
+        ChannelCondition::LosConditionValue los; //!< Evaluated LOS condition
+    };
+
+    /**
+     * \brief Append the inputs of GetGain for a receiver.
+     *
+     * \param txParams parameters of the transmission.
+     * \param rxMobility mobility model of the receiver.
+     * \param rxAntenna antenna of the receiver, or nullptr for an isotropic one.
+     * \param irsPositions current positions of the IRSs.
+     * \param txGeometry geometry of the transmitter with respect to the IRSs.
+     * \param carrier constants of the receiving spectrum model.
+     * \param culled whether the receiver has been culled, in which case placeholders are added.
+     * \param inputs the inputs to append to.
+     */
+    void AddGainInputs(Ptr<const SpectrumSignalParameters> txParams,
+                       Ptr<MobilityModel> rxMobility,
+                       Ptr<AntennaModel> rxAntenna,
+                       const std::vector<Vector>& irsPositions,
+                       const IrsGeometry& txGeometry,
+                       const CarrierParams& carrier,
+                       const bool culled,
+                       GainInputs& inputs);
+
+    /**
+     * \brief Retrieve the geometry of a node with respect to the IRSs, computing it only if any
+     * of the involved nodes moved beyond the GeometryCacheTolerance. K-factors are recomputed
+     * anyway if the ConditionCache attribute is disabled.
+     *
+     * \param node mobility model of the node.
+     * \param irsPositions current positions of the IRSs.
+     * \return the geometry of the node with respect to the IRSs.
+     */
+    const IrsGeometry& GetIrsGeometry(Ptr<MobilityModel> node,
+                                      const std::vector<Vector>& irsPositions);
+
+    /**
+     * \brief Compute the K-factors of the links between a node and the IRSs.
+     *
+     * \param node mobility model of the node.
+     * \param entry the geometry of the node, whose angles are already set.
+     */
+    void SetIrsKFactors(Ptr<MobilityModel> node, IrsGeometry& entry);
+
+    /**
+     * \brief Retrieve the geometry of the direct link between two nodes, computing it only if
+     * any of them moved beyond the GeometryCacheTolerance. The K-factor is recomputed anyway if
+     * the ConditionCache attribute is disabled.
+     *
+     * \param tx mobility model of the transmitter.
+     * \param rx mobility model of the receiver.
+     * \return the geometry of the direct link.
+     */
+    const LinkGeometry& GetLinkGeometry(Ptr<MobilityModel> tx, Ptr<MobilityModel> rx);
+
+    /**
+     * \brief Compute the K-factor of the direct link between two nodes.
+     *
+     * \param tx mobility model of the transmitter.
+     * \param rx mobility model of the receiver.
+     * \param entry the geometry of the link, whose positions are already set.
+     */
+    void SetLinkKFactor(Ptr<MobilityModel> tx, Ptr<MobilityModel> rx, LinkGeometry& entry);
+
+    /**
+     * \brief Retrieve the linear K-factor parameters, converting them again only if the
+     * KMin, KMax or KNlos attributes changed. In that case, the geometry caches, which
+     * embed K-factors, are invalidated as well.
+     *
+     * \return the linear K-factor parameters.
+     */
+    const KFactorParams& GetKFactorParams();
+
+    /**
+     * \brief Retrieve the constants of a receiving spectrum model, computing them only the first
+     * time the model is seen, after IRSs have been added to the IrsList or after the PRU size of
+     * an IRS changed.
+     *
+     * \param model the receiving spectrum model.
+     * \return the carrier constants of the spectrum model.
+     */
+    const CarrierParams& GetCarrierParams(Ptr<const SpectrumModel> model);
+
+    /**
+     * \brief Retrieve the LOS condition between two nodes. The outcome of the channel condition
+     * model is memoized until either node moves.
+     *
+     * \param a mobility model of the first node.
+     * \param b mobility model of the second node.
+     * \return the LOS condition between the two nodes.
+     */
+    ChannelCondition::LosConditionValue GetLosCondition(Ptr<MobilityModel> a,
+                                                        Ptr<MobilityModel> b);
+
+    /**
+     * \brief Retrieve the steering parameters of a serving patch, as in GetServedParam, reusing
+     * the ones cached in the patch as long as neither the IRS nor the served nodes moved beyond
+     * the GeometryCacheTolerance.
+     *
+     * \param irs IRS.
+     * \param patch serving IRS patch.
+     * \param phaseY phase Y.
+     * \param phaseX phase X.
+     * \param distance distance.
+     */
+    void GetServedSteering(Ptr<Irs> irs,
+                           Ptr<IrsPatch> patch,
+                           double& phaseY,
+                           double& phaseX,
+                           double& distance);
+
+    /**
+     * \brief Check whether a position used to compute a cached entry is still valid.
+     *
+     * \param cached position used to compute the entry.
+     * \param current current position.
+     * \return true if the displacement is within GeometryCacheTolerance.
+     */
+    bool IsStillValid(const Vector& cached, const Vector& current) const;
+
     /**
      * \brief Class to calculate the channel gain.
      *
@@ -75,6 +354,7 @@ class IrsAssistedSpectrumChannel : public MultiModelSpectrumChannel
      * \param a_RG angles between IRSs and Ground Users.
      * \param K_BG_nu nu component of the overall gain between Base Station and Ground Users.
      * \param K_BG_sigma sigma component of the overall gain between Base Station and Ground Users.
+     * \param culled whether each Ground User has been culled, and hence its gain is 0.
      * \return the channel gain.
      */
     std::vector<double> GetGain(const double f_c,
@@ -90,7 +370,73 @@ class IrsAssistedSpectrumChannel : public MultiModelSpectrumChannel
                                 const std::vector<Angles>& a_BR,
                                 const std::vector<std::vector<Angles>>& a_RG,
                                 const std::vector<double>& K_BG_nu,
-                                const std::vector<double>& K_BG_sigma);
+                                const std::vector<double>& K_BG_sigma,
+                                const std::vector<bool>& culled);
+
+    /**
+     * \brief Mark the receivers that cannot be reached by a transmission, according to a
+     * conservative upper bound of their direct and reflected gain.
+     *
+     * \param txParams parameters of the transmission.
+     * \param rxPhys receivers of the transmission.
+     * \param irsPositions current positions of the IRSs.
+     * \param d_BR distances between Base Station and IRSs.
+     * \param beta_BG beta of the direct link.
+     * \param beta_BRG betas of IRSs.
+     * \param culled set to true for each receiver that cannot be reached.
+     */
+    void CullReceivers(Ptr<const SpectrumSignalParameters> txParams,
+                       const std::vector<Ptr<SpectrumPhy>>& rxPhys,
+                       const std::vector<Vector>& irsPositions,
+                       const std::vector<double>& d_BR,
+                       const double beta_BG,
+                       const std::vector<double>& beta_BRG,
+                       std::vector<bool>& culled);
+
+    /**
+     * \brief Class that returns the maximum ratio between the gain and the mean received power.
+     *
+     * \return the ratio, or 0 if it cannot be bounded for the current outage probability.
+     */
+    double GetGainBoundFactor() const;
+
+    /**
+     * \brief Class that returns the maximum gain of an antenna.
+     *
+     * \param antenna the antenna model, or nullptr for an isotropic antenna.
+     * \return the maximum linear gain, or infinity if it cannot be determined.
+     */
+    double GetMaxAntennaGain(Ptr<const Object> antenna);
+
+    /**
+     * \brief Class to calculate the mean power of the received field through the coherent
+     * phasor sum of the reflected contributions and the direct link.
+     *
+     * \param modules modules of the reflected contributions, for each IRS and for each patch.
+     * \param phases phases of the reflected contributions, for each IRS and for each patch.
+     * \param directNu nu component of the direct link.
+     * \param directPhase phase of the direct link.
+     * \return the nu component of the overall gain.
+     */
+    double GetPhasorNu(const std::vector<std::vector<double>>& modules,
+                       const std::vector<std::vector<double>>& phases,
+                       const double directNu,
+                       const double directPhase) const;
+
+    /**
+     * \brief Class to calculate the mean power of the received field by accumulating the
+     * contribution of each pair of patches. It is kept as a reference for GetPhasorNu.
+     *
+     * \param modules modules of the reflected contributions, for each IRS and for each patch.
+     * \param phases phases of the reflected contributions, for each IRS and for each patch.
+     * \param directNu nu component of the direct link.
+     * \param directPhase phase of the direct link.
+     * \return the nu component of the overall gain.
+     */
+    double GetPairwiseNu(const std::vector<std::vector<double>>& modules,
+                         const std::vector<std::vector<double>>& phases,
+                         const double directNu,
+                         const double directPhase) const;
 
     /**
      * \brief Class to set the Inverse Q function.
@@ -208,6 +554,31 @@ class IrsAssistedSpectrumChannel : public MultiModelSpectrumChannel
     bool m_noDirectLink;
     bool m_noIrsLink;
     MultipathInterferenceType m_multipathType;
+    IrsGainEngineType m_gainEngine;
+    double m_crossCheckTolerance;
+    bool m_geometryCacheEnabled;
+    double m_geometryCacheTolerance;
+    std::map<const MobilityModel*, IrsGeometry> m_irsGeometryCache;
+    std::map<std::pair<const MobilityModel*, const MobilityModel*>, LinkGeometry>
+        m_linkGeometryCache;
+    uint64_t m_geometryCacheHits;
+    uint64_t m_geometryCacheMisses;
+    Ptr<ChannelConditionModel> m_conditionModel;
+    bool m_conditionCacheEnabled;
+    std::map<std::pair<const MobilityModel*, const MobilityModel*>, LosCondition> m_losCache;
+    std::unique_ptr<WorkerPool> m_workerPool;
+    bool m_rangeCulling;
+    double m_rangeCullingCellSize;
+    std::map<const Object*, double> m_maxAntennaGains;
+    IrsArrayFactor::KernelType m_arrayFactorKernel;
+    bool m_batchTransmissions;
+    std::vector<Ptr<SpectrumSignalParameters>> m_pendingTx;
+    bool m_flushPending;
+    uint64_t m_batchCounter;
+    uint64_t m_batchId;
+    KFactorParams m_kFactorParams;
+    std::map<SpectrumModelUid_t, CarrierParams> m_carrierParams;
+    Ptr<MobilityModel> m_probe;
 };
 
 } // namespace ns3
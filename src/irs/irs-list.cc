@@ -31,6 +31,9 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("IrsList");
 
+/// Monotonic counter of the modifications of the IrsList, kept across list re-creations
+static uint64_t g_irsListVersion = 0;
+
 /**
  * \ingroup Irs
  * \brief private implementation detail of the IrsList API
@@ -172,6 +175,7 @@ IrsListPriv::Add(Ptr<Irs> irs)
     uint32_t index = m_irss.size();
 
     m_irss.push_back(irs);
+    ++g_irsListVersion;
     Simulator::ScheduleWithContext(index, TimeStep(0), &Irs::Initialize, irs);
 
     return index;
@@ -271,4 +275,10 @@ IrsList::GetN()
     return IrsListPriv::Get()->GetN();
 }
 
+uint64_t
+IrsList::GetVersion()
+{
+    return g_irsListVersion;
+}
+
 } // namespace ns3
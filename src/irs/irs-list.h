@@ -72,6 +72,12 @@ class IrsList
      * \returns the number of Irs currently in the list
      */
     static uint32_t GetN();
+
+    /**
+     * \returns a counter that changes every time an Irs is added to the list, so that
+     * derived data can be cached and invalidated whenever the list is modified.
+     */
+    static uint64_t GetVersion();
 };
 
 } // namespace ns3
@@ -151,6 +151,7 @@ IrsPatch::SetServingNodes(Ptr<Node> n1, Ptr<Node> n2)
     NS_ASSERT_MSG(n1 && n2, "ServingNodes must be set with two valid nodes.");
     m_isServing = true;
     m_servingNodes = std::make_pair(n1, n2);
+    InvalidateSteering();
 }
 
 void
@@ -207,6 +208,25 @@ IrsPatch::GetLifeTime() const
     return m_lifetime;
 }
 
+const IrsPatch::Steering&
+IrsPatch::GetSteering() const
+{
+    return m_steering;
+}
+
+void
+IrsPatch::SetSteering(const IrsPatch::Steering& steering)
+{
+    m_steering = steering;
+    m_steering.valid = true;
+}
+
+void
+IrsPatch::InvalidateSteering()
+{
+    m_steering.valid = false;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const IrsPatch::Size& size)
 {
@@ -23,6 +23,7 @@
 #include <ns3/node.h>
 #include <ns3/object.h>
 #include <ns3/str-vec.h>
+#include <ns3/vector.h>
 
 #include <vector>
 
@@ -73,6 +74,21 @@ class IrsPatch : public Object
         uint32_t endRowIdx;
     };
 
+    /**
+     * Steering parameters of a serving patch towards its served nodes, together with the
+     * positions they have been computed for.
+     */
+    struct Steering
+    {
+        bool valid{false};    //!< Whether the parameters have been computed
+        Vector irsPosition;   //!< IRS position used to compute the parameters
+        Vector node1Position; //!< First served node position used to compute the parameters
+        Vector node2Position; //!< Second served node position used to compute the parameters
+        double phaseX{0.};    //!< Phase shift along the X-axis
+        double phaseY{0.};    //!< Phase shift along the Y-axis
+        double distance{0.};  //!< Length of the path between the served nodes through the IRS
+    };
+
     static TypeId GetTypeId();
 
     IrsPatch();
@@ -116,6 +132,12 @@ class IrsPatch : public Object
     void SetLifeTime(const double l);
     /**Get life periods**/
     const double GetLifeTime() const;
+    /** Retrieve the cached steering parameters towards the served nodes. */
+    const Steering& GetSteering() const;
+    /** Cache the steering parameters towards the served nodes. */
+    void SetSteering(const Steering& steering);
+    /** Discard the cached steering parameters, e.g., when the served nodes change. */
+    void InvalidateSteering();
 
   protected:
     void DoInitialize(void);
@@ -130,6 +152,7 @@ class IrsPatch : public Object
                      /// Node)
     std::pair<Ptr<Node>, Ptr<Node>> m_servingNodes; /// The Nodes served by this Patch
     double m_lifetime;                              /// The life time of this Patch
+    Steering m_steering; /// Cached steering parameters towards the served nodes
 };
 
 ATTRIBUTE_HELPER_HEADER(IrsPatch);
@@ -52,6 +52,7 @@
 #include <ns3/object-factory.h>
 #include <ns3/ptr.h>
 #include <ns3/radio-environment-map-helper.h>
+#include <ns3/rem-output.h>
 #include <ns3/remote-list.h>
 #include <ns3/report.h>
 #include <ns3/rng-seed-manager.h>
@@ -97,7 +98,7 @@ class Scenario
 
   private:
     void GenerateRadioMap();
-    void GenerateThreeDimensionalRem();
+    void GenerateThreeDimensionalRem(bool lte);
     void ApplyStaticConfig();
     void ConfigureWorld();
     void ConfigurePhy();
@@ -225,51 +226,28 @@ Scenario::operator()()
 
     if (CONFIGURATOR->RadioMap() > 0)
     {
-        NS_ASSERT_MSG(anyLte,
-                      "Environment Radio Map can be generated only if an LTE network is "
-                      "present. Aborting simulation.");
         NS_LOG_INFO("Generating Environment Radio Map, simulation will not run.");
         if (CONFIGURATOR->RadioMap() == 2)
         {
-            this->GenerateThreeDimensionalRem();
+            this->GenerateThreeDimensionalRem(anyLte);
             Simulator::Run();
             Simulator::Destroy();
-            int plyRet = system(("python ../analysis/txt2ply.py " + CONFIGURATOR->GetResultsPath() +
-                                 CONFIGURATOR->GetName() + "-3D-REM.txt")
-                                    .c_str());
-            if (plyRet == -1)
-            {
-                NS_ABORT_MSG("Something went wrong while generating the ply file");
-            }
-            int plotRet =
-                system(("python ../analysis/rem-3d-preview.py " + CONFIGURATOR->GetResultsPath() +
-                        CONFIGURATOR->GetName() + "-3D-REM.ply")
-                           .c_str());
-            if (plotRet != 0)
-            {
-                NS_ABORT_MSG("Something went wrong while generating the plot");
-            }
+            std::cout << "3D REM saved, preview it with: python ../analysis/rem-3d-preview.py "
+                      << CONFIGURATOR->GetResultsPath() << CONFIGURATOR->GetName()
+                      << "-3D-REM.ply" << std::endl;
         }
         else if (CONFIGURATOR->RadioMap() == 1)
         {
+            NS_ASSERT_MSG(anyLte,
+                          "2D Environment Radio Map can be generated only if an LTE network is "
+                          "present, use the 3D one for other networks. Aborting simulation.");
             this->GenerateRadioMap();
             Simulator::Run();
             Simulator::Destroy();
-            int plyRet = system(("python ../analysis/txt2ply.py " + CONFIGURATOR->GetResultsPath() +
-                                 CONFIGURATOR->GetName() + "-2D-REM.txt")
-                                    .c_str());
-            if (plyRet != 0)
-            {
-                NS_ABORT_MSG("Something went wrong while generating the ply file");
-            }
-            int plotRet =
-                system(("python ../analysis/rem-2d-preview.py " + CONFIGURATOR->GetResultsPath() +
-                        CONFIGURATOR->GetName() + "-2D-REM.txt")
-                           .c_str());
-            if (plotRet != 0)
-            {
-                NS_ABORT_MSG("Something went wrong while generating the plot");
-            }
+            const auto remPath = CONFIGURATOR->GetResultsPath() + CONFIGURATOR->GetName();
+            RemPlyWriter::ConvertText(remPath + "-2D-REM.txt", remPath + "-2D-REM.ply");
+            std::cout << "2D REM saved, preview it with: python ../analysis/rem-2d-preview.py "
+                      << remPath << "-2D-REM.txt" << std::endl;
         }
     }
     else
@@ -315,13 +293,25 @@ Scenario::GenerateRadioMap()
 }
 
 void
-Scenario::GenerateThreeDimensionalRem()
+Scenario::GenerateThreeDimensionalRem(bool lte)
 {
     // Making it static in order for it to be alive when simulation run
     static Ptr<ThreeDimensionalRemHelper> m_remHelper = CreateObject<ThreeDimensionalRemHelper>();
+    if (!lte)
+    {
+        // Without LTE, only the DIRECT engine can map the transmissions on the channel
+        m_remHelper->SetAttribute("Engine", StringValue("DIRECT"));
+        m_remHelper->SetAttribute("Signals", StringValue("ALL"));
+    }
     m_remHelper->SetAttribute(
         "OutputFile",
         StringValue(CONFIGURATOR->GetResultsPath() + CONFIGURATOR->GetName() + "-3D-REM.txt"));
+    m_remHelper->SetAttribute(
+        "PlyOutputFile",
+        StringValue(CONFIGURATOR->GetResultsPath() + CONFIGURATOR->GetName() + "-3D-REM.ply"));
+    m_remHelper->SetAttribute(
+        "GridOutputFile",
+        StringValue(CONFIGURATOR->GetResultsPath() + CONFIGURATOR->GetName() + "-3D-REM.bin"));
 
     auto parameters = CONFIGURATOR->GetRadioMapParameters();
     for (auto par : parameters)
@@ -20,6 +20,7 @@
 #include <ns3/log.h>
 #include <ns3/vector.h>
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -30,14 +31,13 @@ NS_LOG_COMPONENT_DEFINE("ConstantAccelerationFlight");
 
 ConstantAccelerationFlight::ConstantAccelerationFlight(FlightPlan flightPlan,
                                                        ConstantAccelerationParam flightParam,
-                                                       double step)
-    : Curve(flightPlan, step),
+                                                       double step,
+                                                       double tolerance,
+                                                       const std::string& cacheDirectory)
+    : Curve(flightPlan, step, tolerance, cacheDirectory),
       m_acceleration{flightParam.GetAcceleration()},
       m_maxSpeed{flightParam.GetMaxSpeed()},
-      m_isHovering{flightPlan.GetN() == 1},
-      m_currentDistance{0.0},
-      m_currentT{0.0},
-      m_currentSpeed{0.0}
+      m_isHovering{flightPlan.GetN() == 1}
 {
     NS_LOG_FUNCTION(this << m_acceleration << m_maxSpeed);
 
@@ -53,26 +53,30 @@ ConstantAccelerationFlight::Generate()
     {
         // this is a dummy flight plan to hover on a specific point.
         m_length = 0;
-        m_currentVelocity = Vector3D();
+        m_cruiseSpeed = 0;
+        m_accelerationZoneLength = 0;
+        m_accelerationZoneTime = 0;
         m_time = m_knots.GetBack()->GetRestTime();
     }
     else
     {
         m_length = Curve::Generate();
-        m_accelerationZoneLength = 0.5 * std::pow(m_maxSpeed, 2) / m_acceleration;
-        m_accelerationZoneTime = m_maxSpeed / m_acceleration;
+
+        // in case the trajectory is too short to ever reach m_maxSpeed, the drone starts
+        // decelerating right after the half of it
+        m_cruiseSpeed = std::min(m_maxSpeed, std::sqrt(m_acceleration * m_length));
+        m_accelerationZoneLength = 0.5 * std::pow(m_cruiseSpeed, 2) / m_acceleration;
+        m_accelerationZoneTime = m_cruiseSpeed / m_acceleration;
 
         const double aZonesL = 2 * m_accelerationZoneLength; // total length of acceleration zones
         const double aZonesT = 2 * m_accelerationZoneTime;   // total time of acceleration zones
 
-        m_time = Seconds(aZonesT + (m_length - aZonesL) / m_maxSpeed);
-
-        if (m_time.GetSeconds() <=
-            aZonesT) // in case the trajectory is too short to never reach m_maxSpeed
-            m_time = Seconds(std::sqrt(4.0 * m_length / m_acceleration));
+        m_time = (m_cruiseSpeed > 0) ? Seconds(aZonesT + (m_length - aZonesL) / m_cruiseSpeed)
+                                     : Seconds(0);
     }
 
-    m_currentPosition = CurvePoint(m_knots.GetFront()->GetPosition());
+    m_currentPosition = m_knots.GetFront()->GetPosition();
+    m_currentVelocity = Vector3D();
 }
 
 void
@@ -83,20 +87,11 @@ ConstantAccelerationFlight::Update(const double& t) const
     if (m_isHovering)
         return;
 
-    double a = (m_currentSpeed < m_maxSpeed) ? m_acceleration : 0.0;
-
-    if (m_currentDistance >= m_length - 0.5 * std::pow(m_currentSpeed, 2) / m_acceleration)
-        a = -m_acceleration;
-
-    m_currentDistance += m_currentSpeed * (t - m_currentT) + 0.5 * a * std::pow(t - m_currentT, 2);
-    m_currentSpeed += a * (t - m_currentT);
-    m_currentT = t;
+    m_currentPosition = GetPosition(t);
+    m_currentVelocity = GetVelocity(t);
 
-    UpdatePosition();
-    UpdateVelocity();
-
-    NS_LOG_LOGIC("Current speed: " << m_currentSpeed);
-    NS_LOG_LOGIC("Current distance: " << m_currentDistance);
+    NS_LOG_LOGIC("Current position: " << m_currentPosition);
+    NS_LOG_LOGIC("Current velocity: " << m_currentVelocity);
 }
 
 Time
@@ -108,7 +103,7 @@ ConstantAccelerationFlight::GetTime() const
 Vector
 ConstantAccelerationFlight::GetPosition() const
 {
-    return m_currentPosition.GetPosition();
+    return m_currentPosition;
 }
 
 Vector
@@ -117,50 +112,60 @@ ConstantAccelerationFlight::GetVelocity() const
     return m_currentVelocity;
 }
 
-void
-ConstantAccelerationFlight::UpdatePosition() const
+double
+ConstantAccelerationFlight::GetDistance(const double& t) const
 {
-    NS_LOG_FUNCTION(this);
-    NS_LOG_LOGIC("old pos vector: " << m_currentPosition.GetPosition());
-    m_pastPosition = m_currentPosition;
-
-    for (auto i = m_curve.begin(); i != m_curve.end(); i++)
-    {
-        if ((*i).GetAbsoluteDistance() > m_currentDistance)
-        {
-            m_currentPosition = (*i);
-            break;
-        }
-    }
-
-    NS_LOG_LOGIC("new pos vector: " << m_currentPosition.GetPosition());
+    const double cruiseEnd = m_time.GetSeconds() - m_accelerationZoneTime;
+
+    if (t <= 0.0)
+        return 0.0;
+    else if (t < m_accelerationZoneTime)
+        return 0.5 * m_acceleration * std::pow(t, 2);
+    else if (t < cruiseEnd)
+        return m_accelerationZoneLength + m_cruiseSpeed * (t - m_accelerationZoneTime);
+    else if (t < m_time.GetSeconds())
+        return m_length - 0.5 * m_acceleration * std::pow(m_time.GetSeconds() - t, 2);
+    else
+        return m_length;
 }
 
-void
-ConstantAccelerationFlight::UpdateVelocity() const
+double
+ConstantAccelerationFlight::GetSpeed(const double& t) const
 {
-    NS_LOG_FUNCTION(this);
-    NS_LOG_LOGIC("old vel: " << m_currentVelocity);
+    const double cruiseEnd = m_time.GetSeconds() - m_accelerationZoneTime;
+
+    if (t <= 0.0 || t >= m_time.GetSeconds())
+        return 0.0;
+    else if (t < m_accelerationZoneTime)
+        return m_acceleration * t;
+    else if (t < cruiseEnd)
+        return m_cruiseSpeed;
+    else
+        return m_acceleration * (m_time.GetSeconds() - t);
+}
 
-    const Vector relativeDistance = m_currentPosition.GetRelativeDistanceVector(m_pastPosition);
-    const double relativeDistScalar = m_currentPosition.GetRelativeDistance(m_pastPosition);
+Vector
+ConstantAccelerationFlight::GetPosition(const double& t) const
+{
+    NS_LOG_FUNCTION(this << t);
 
-    if (relativeDistScalar == 0.0)
-        return;
+    if (m_isHovering)
+        return m_knots.GetFront()->GetPosition();
 
-    const double velX =
-        (relativeDistance.x != 0) ? (relativeDistance.x / relativeDistScalar) * m_currentSpeed : 0;
-    const double velY =
-        (relativeDistance.y != 0) ? (relativeDistance.y / relativeDistScalar) * m_currentSpeed : 0;
-    const double velZ =
-        (relativeDistance.z != 0) ? (relativeDistance.z / relativeDistScalar) * m_currentSpeed : 0;
+    return GetPositionAt(GetDistance(t));
+}
 
-    NS_LOG_LOGIC("relative distance: " << relativeDistance
-                                       << "; current speed: " << m_currentSpeed);
+Vector
+ConstantAccelerationFlight::GetVelocity(const double& t) const
+{
+    NS_LOG_FUNCTION(this << t);
 
-    m_currentVelocity = {velX, velY, velZ};
+    const double speed = m_isHovering ? 0.0 : GetSpeed(t);
+    if (speed == 0.0)
+        return Vector3D();
 
-    NS_LOG_LOGIC("new vel: " << m_currentVelocity);
+    const Vector direction = GetDirectionAt(GetDistance(t));
+    return {direction.x * speed, direction.y * speed, direction.z * speed};
 }
 
 } // namespace ns3
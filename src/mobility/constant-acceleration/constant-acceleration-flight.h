@@ -36,7 +36,9 @@ class ConstantAccelerationFlight : public Curve
   public:
     ConstantAccelerationFlight(FlightPlan flightPlan,
                                ConstantAccelerationParam flightParam,
-                               double step);
+                               double step,
+                               double tolerance = 0.0,
+                               const std::string& cacheDirectory = "");
 
     void Generate();
     void Update(const double& time) const;
@@ -45,10 +47,33 @@ class ConstantAccelerationFlight : public Curve
     Vector GetPosition() const;
     Vector GetVelocity() const;
 
-  protected:
-    void UpdatePosition() const;
-    void UpdateVelocity() const;
+    /**
+     * \brief Evaluate the flight at a given time, regardless of any previous query.
+     *
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the position of the drone.
+     */
+    Vector GetPosition(const double& time) const;
+    /**
+     * \brief Evaluate the flight at a given time, regardless of any previous query.
+     *
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the velocity of the drone.
+     */
+    Vector GetVelocity(const double& time) const;
+    /**
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the distance travelled along the curve, accelerating up to the cruise speed,
+     *         cruising and finally decelerating to stop on the last point.
+     */
+    double GetDistance(const double& time) const;
+    /**
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the scalar speed of the drone.
+     */
+    double GetSpeed(const double& time) const;
 
+  protected:
     double m_length; /// Total length of the trajectory
     Time m_time;     /// Total time the drone would take to complete it
 
@@ -56,16 +81,12 @@ class ConstantAccelerationFlight : public Curve
     double m_maxSpeed;     // m/s
     bool m_isHovering;
 
+    double m_cruiseSpeed; /// Peak speed, lower than m_maxSpeed if the trajectory is short
     double m_accelerationZoneLength;
     double m_accelerationZoneTime;
 
-    mutable CurvePoint m_currentPosition;
-    mutable CurvePoint m_pastPosition;
-    mutable double m_currentDistance;
-    mutable double m_currentT;
-
+    mutable Vector m_currentPosition;
     mutable Vector m_currentVelocity;
-    mutable double m_currentSpeed;
 };
 
 } // namespace ns3
@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "curve-cache.h"
+
+#include <ns3/hash.h>
+#include <ns3/log.h>
+#include <ns3/system-path.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CurveCache");
+
+constexpr char CurveCacheHeader::MAGIC[8];
+constexpr uint32_t CurveCacheHeader::VERSION;
+
+bool
+CurveCache::Load(const std::string& directory,
+                 const std::vector<Vector>& knots,
+                 const float step,
+                 const double tolerance,
+                 std::vector<CurvePoint>& curve)
+{
+    NS_LOG_FUNCTION(directory << knots.size() << step << tolerance);
+
+    const auto keyValues = GetKeyValues(knots, step, tolerance);
+    const auto key = GetKey(keyValues);
+    const std::string path = GetPath(directory, key);
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        NS_LOG_LOGIC("Curve " << path << " is not cached.");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CurveCacheHeader))
+    {
+        NS_LOG_WARN("Ignoring invalid curve cache file " << path);
+        close(fd);
+        return false;
+    }
+
+    const size_t size = st.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        NS_LOG_WARN("Can't map curve cache file " << path);
+        return false;
+    }
+
+    const auto header = static_cast<const CurveCacheHeader*>(data);
+    const auto storedKeyValues = reinterpret_cast<const double*>(
+        static_cast<const char*>(data) + sizeof(CurveCacheHeader));
+    const bool valid =
+        std::memcmp(header->magic, CurveCacheHeader::MAGIC, sizeof(header->magic)) == 0 &&
+        header->version == CurveCacheHeader::VERSION && header->key == key &&
+        header->nKeyValues == keyValues.size() && header->nPoints > 0 &&
+        sizeof(CurveCacheHeader) + header->nKeyValues * sizeof(double) +
+                header->nPoints * sizeof(CurveCachePoint) ==
+            size;
+
+    // The key is just a hash, thus the curve is accepted only if it was generated from the same
+    // knots, step and tolerance
+    const bool match =
+        valid &&
+        std::memcmp(storedKeyValues, keyValues.data(), keyValues.size() * sizeof(double)) == 0;
+
+    if (match)
+    {
+        const auto points =
+            reinterpret_cast<const CurveCachePoint*>(storedKeyValues + header->nKeyValues);
+
+        curve.clear();
+        curve.reserve(header->nPoints);
+        for (uint64_t i = 0; i < header->nPoints; i++)
+        {
+            const auto& p = points[i];
+            curve.push_back({{p.x, p.y, p.z}, p.t, p.relativeDistance, p.absoluteDistance});
+        }
+
+        NS_LOG_LOGIC("Loaded " << curve.size() << " points from " << path);
+    }
+    else if (valid)
+    {
+        NS_LOG_WARN("Ignoring curve cache file " << path << " of a different curve");
+    }
+    else
+    {
+        NS_LOG_WARN("Ignoring invalid curve cache file " << path);
+    }
+
+    munmap(data, size);
+    return match;
+}
+
+void
+CurveCache::Store(const std::string& directory,
+                  const std::vector<Vector>& knots,
+                  const float step,
+                  const double tolerance,
+                  const std::vector<CurvePoint>& curve)
+{
+    NS_LOG_FUNCTION(directory << knots.size() << step << tolerance << curve.size());
+
+    if (curve.empty())
+        return;
+
+    SystemPath::MakeDirectories(directory);
+
+    const auto keyValues = GetKeyValues(knots, step, tolerance);
+    const auto key = GetKey(keyValues);
+    const std::string path = GetPath(directory, key);
+    std::ostringstream tmpPath;
+    tmpPath << path << ".tmp." << getpid();
+
+    CurveCacheHeader header;
+    std::memcpy(header.magic, CurveCacheHeader::MAGIC, sizeof(header.magic));
+    header.version = CurveCacheHeader::VERSION;
+    header.reserved = 0;
+    header.key = key;
+    header.nKeyValues = keyValues.size();
+    header.nPoints = curve.size();
+
+    std::vector<CurveCachePoint> points;
+    points.reserve(curve.size());
+    for (const auto& p : curve)
+    {
+        const Vector position = p.GetPosition();
+        points.push_back({position.x,
+                          position.y,
+                          position.z,
+                          p.GetRelativeDistance(),
+                          p.GetAbsoluteDistance(),
+                          p.GetT(),
+                          0});
+    }
+
+    std::ofstream file(tmpPath.str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(keyValues.data()),
+               keyValues.size() * sizeof(double));
+    file.write(reinterpret_cast<const char*>(points.data()),
+               points.size() * sizeof(CurveCachePoint));
+    file.close();
+
+    // rename is atomic, hence concurrent simulations never read a partial file
+    if (!file || std::rename(tmpPath.str().c_str(), path.c_str()) != 0)
+    {
+        NS_LOG_WARN("Can't store curve in cache file " << path);
+        std::remove(tmpPath.str().c_str());
+        return;
+    }
+
+    NS_LOG_LOGIC("Stored " << curve.size() << " points in " << path);
+}
+
+std::vector<double>
+CurveCache::GetKeyValues(const std::vector<Vector>& knots, const float step, const double tolerance)
+{
+    std::vector<double> values;
+    values.reserve(3 * knots.size() + 3);
+
+    values.push_back(CurveCacheHeader::VERSION);
+    values.push_back(step);
+    values.push_back(tolerance);
+    for (const auto& k : knots)
+    {
+        values.push_back(k.x);
+        values.push_back(k.y);
+        values.push_back(k.z);
+    }
+
+    return values;
+}
+
+uint64_t
+CurveCache::GetKey(const std::vector<double>& keyValues)
+{
+    auto hashf = Hash::Function::Fnv1a();
+    return hashf.GetHash64(reinterpret_cast<const char*>(keyValues.data()),
+                           keyValues.size() * sizeof(double));
+}
+
+std::string
+CurveCache::GetPath(const std::string& directory, const uint64_t key)
+{
+    std::ostringstream path;
+    path << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".curve";
+    return path.str();
+}
+
+} // namespace ns3
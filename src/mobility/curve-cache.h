@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CURVE_CACHE_H
+#define CURVE_CACHE_H
+
+#include "curve-point.h"
+
+#include <ns3/vector.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mobility
+ * \brief A persistent cache of generated curves, to skip their generation in
+ *        campaigns that run the same flight plans over and over.
+ *
+ * Each curve is stored in its own file of a cache directory, named after a
+ * hash of the virtual knots, the step and the tolerance of the curve. The
+ * file is a CurveCacheHeader followed by the hashed values and by the points
+ * of the curve, stored as is, and it is memory-mapped when loaded. The hashed
+ * values are compared on load, so that a hash collision or a stale file never
+ * replaces the curve. Files are written to a temporary file and then renamed,
+ * so that simulations running in parallel can share a directory.
+ */
+class CurveCache
+{
+  public:
+    /**
+     * \brief Load a curve from the cache.
+     *
+     * \param directory the cache directory.
+     * \param knots     the positions of the virtual knots of the curve.
+     * \param step      the step of the curve.
+     * \param tolerance the chord tolerance of the curve.
+     * \param curve     the points of the curve, filled in if found.
+     * \return whether the curve was found and is valid.
+     */
+    static bool Load(const std::string& directory,
+                     const std::vector<Vector>& knots,
+                     const float step,
+                     const double tolerance,
+                     std::vector<CurvePoint>& curve);
+
+    /**
+     * \brief Store a curve in the cache. Failures are logged and ignored, as
+     *        the cache is just an optimization.
+     *
+     * \param directory the cache directory, created if needed.
+     * \param knots     the positions of the virtual knots of the curve.
+     * \param step      the step of the curve.
+     * \param tolerance the chord tolerance of the curve.
+     * \param curve     the points of the curve.
+     */
+    static void Store(const std::string& directory,
+                      const std::vector<Vector>& knots,
+                      const float step,
+                      const double tolerance,
+                      const std::vector<CurvePoint>& curve);
+
+  private:
+    /**
+     * \param knots     the positions of the virtual knots of the curve.
+     * \param step      the step of the curve.
+     * \param tolerance the chord tolerance of the curve.
+     * \return the values hashed into the key of the curve.
+     */
+    static std::vector<double> GetKeyValues(const std::vector<Vector>& knots,
+                                            const float step,
+                                            const double tolerance);
+
+    /**
+     * \param keyValues the values hashed into the key of a curve.
+     * \return the key of the curve.
+     */
+    static uint64_t GetKey(const std::vector<double>& keyValues);
+
+    /**
+     * \param directory the cache directory.
+     * \param key       the key of the curve.
+     * \return the path of the file of the curve.
+     */
+    static std::string GetPath(const std::string& directory, const uint64_t key);
+};
+
+/**
+ * \ingroup mobility
+ * \brief Header of a curve cache file.
+ */
+struct CurveCacheHeader
+{
+    char magic[8];     //!< File signature, i.e., MAGIC
+    uint32_t version;  //!< Version of the format, i.e., VERSION
+    uint32_t reserved; //!< Reserved, set to zero
+    uint64_t key;        //!< Key of the curve
+    uint64_t nKeyValues; //!< Number of values hashed into the key, following the header
+    uint64_t nPoints;    //!< Number of points of the curve, following the hashed values
+
+    /// Signature of a curve cache file
+    static constexpr char MAGIC[8] = {'I', 'O', 'D', 'S', 'C', 'R', 'V', '\0'};
+    /// Version of the format
+    static constexpr uint32_t VERSION = 2;
+};
+
+/**
+ * \ingroup mobility
+ * \brief A point of a curve cache file.
+ */
+struct CurveCachePoint
+{
+    double x;                //!< X coordinate
+    double y;                //!< Y coordinate
+    double z;                //!< Z coordinate
+    double relativeDistance; //!< Distance from the preceding point
+    double absoluteDistance; //!< Distance from the origin of the curve
+    float t;                 //!< Parameter of the curve
+    uint32_t reserved;       //!< Reserved, set to zero
+};
+
+} // namespace ns3
+
+#endif /* CURVE_CACHE_H */
@@ -85,6 +85,18 @@ CurvePoint::GetAbsoluteDistance() const
     return m_absoluteDistance;
 }
 
+const double
+CurvePoint::GetRelativeDistance() const
+{
+    return m_relativeDistance;
+}
+
+const float
+CurvePoint::GetT() const
+{
+    return m_t;
+}
+
 const Vector
 CurvePoint::GetPosition() const
 {
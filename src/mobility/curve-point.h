@@ -83,6 +83,18 @@ class CurvePoint
      */
     const double GetAbsoluteDistance() const;
 
+    /**
+     * \brief get the distance from the point preceding this one on the curve
+     *
+     * \return the euclidean distance from the preceding point
+     */
+    const double GetRelativeDistance() const;
+
+    /**
+     * \return the parameter used by the curve for the generation of the point
+     */
+    const float GetT() const;
+
     /**
      * \return the location of this point in space
      */
@@ -17,12 +17,16 @@
  */
 #include "curve.h"
 
+#include "curve-cache.h"
+
 #include <ns3/integer.h>
 #include <ns3/log.h>
 #include <ns3/object-factory.h>
 #include <ns3/vector.h>
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <vector>
 
 namespace ns3
@@ -59,25 +63,64 @@ class CurvePriv
 
         return virtualKnots;
     }
+
+    /**
+     * Get the positions of the knots, to avoid dereferencing them on every sample.
+     */
+    static const std::vector<Vector> GetPositions(const FlightPlan knots)
+    {
+        std::vector<Vector> positions;
+        positions.reserve(knots.GetN());
+
+        for (auto k = knots.Begin(); k != knots.End(); k++)
+            positions.push_back((*k)->GetPosition());
+
+        return positions;
+    }
+
+    /**
+     * Get ln(C(r, i)) for i in [0, r], where r is the degree of a curve with n knots.
+     */
+    static const std::vector<double> GetLogBinomials(const size_t n)
+    {
+        std::vector<double> logBinomials(n, 0.0);
+        const double r = n - 1;
+
+        for (size_t i = 0; i < n; i++)
+            logBinomials[i] = std::lgamma(r + 1) - std::lgamma(i + 1.0) - std::lgamma(r - i + 1);
+
+        return logBinomials;
+    }
 };
 
-Curve::Curve(const FlightPlan knots, const float step)
+Curve::Curve(const FlightPlan knots,
+             const float step,
+             const double tolerance,
+             const std::string& cacheDirectory)
     : m_knots{CurvePriv::GetVirtualKnots(knots)},
       m_knotsN{knots.GetN()},
-      m_step{step}
+      m_step{step},
+      m_tolerance{tolerance},
+      m_cacheDirectory{cacheDirectory},
+      m_knotPositions{CurvePriv::GetPositions(m_knots)},
+      m_logBinomials{CurvePriv::GetLogBinomials(m_knots.GetN())}
 {
-    NS_LOG_FUNCTION(knots.GetN() << step);
+    NS_LOG_FUNCTION(knots.GetN() << step << tolerance << cacheDirectory);
 }
 
 Curve::Curve(const FlightPlan knots)
     : m_knots{CurvePriv::GetVirtualKnots(knots)},
-      m_knotsN{knots.GetN()}
+      m_knotsN{knots.GetN()},
+      m_tolerance{0.0},
+      m_knotPositions{CurvePriv::GetPositions(m_knots)},
+      m_logBinomials{CurvePriv::GetLogBinomials(m_knots.GetN())}
 {
     NS_LOG_FUNCTION(knots.GetN());
 }
 
 Curve::Curve()
-    : m_step{0.1}
+    : m_step{0.1},
+      m_tolerance{0.0}
 {
     NS_LOG_FUNCTION_NOARGS();
 }
@@ -87,58 +130,220 @@ Curve::Generate() const
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    if (!m_cacheDirectory.empty() &&
+        CurveCache::Load(m_cacheDirectory, m_knotPositions, m_step, m_tolerance, m_curve))
+    {
+        NS_LOG_INFO("Loaded curve with " << m_curve.size() << " points from cache.");
+        return m_curve.back().GetAbsoluteDistance();
+    }
+
+    const double length = (m_tolerance > 0.0) ? GenerateAdaptive() : GenerateUniform();
+
+    if (!m_cacheDirectory.empty())
+        CurveCache::Store(m_cacheDirectory, m_knotPositions, m_step, m_tolerance, m_curve);
+
+    return length;
+}
+
+const double
+Curve::GenerateUniform() const
+{
+    NS_LOG_FUNCTION_NOARGS();
+
     double absoluteDistance = 0.0;
 
     NS_LOG_LOGIC("Constructing Bézier curve with " << m_knotsN << " knots.");
     for (float t = 0.0; t < 1.0; t += m_step)
+        absoluteDistance = Append(GetPoint(t), t);
+
+    NS_LOG_INFO("Generated curve with " << m_curve.size() << " points.");
+    return absoluteDistance;
+}
+
+size_t
+Curve::GetN() const
+{
+    return m_curve.size();
+}
+
+const double
+Curve::GenerateAdaptive() const
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    // start from a uniform partition, so that features symmetric to the
+    // midpoint of a segment are not missed
+    const size_t maxSegments = std::max<size_t>(1, std::ceil(1.0 / m_step));
+    const size_t segments = std::min(std::max<size_t>(16, 2 * m_knots.GetN()), maxSegments);
+
+    NS_LOG_LOGIC("Constructing Bézier curve with " << m_knotsN << " knots, starting from "
+                                                   << segments << " segments.");
+
+    float t0 = 0.0;
+    Vector p0 = GetPoint(t0);
+    Append(p0, t0);
+
+    for (size_t i = 1; i <= segments; i++)
     {
-        const Vector point = GetPoint(t);
-        double relativeDistance = 0.0;
+        const float t1 = static_cast<float>(i) / segments;
+        const Vector p1 = GetPoint(t1);
 
-        if (!m_curve.empty())
-        {
-            relativeDistance = m_curve.back().GetRelativeDistance(point);
-            absoluteDistance += relativeDistance;
-        }
+        Subdivide(t0, p0, t1, p1);
 
-        NS_LOG_LOGIC("  NP:  " << point << " | t: " << t << " | rD: " << relativeDistance
-                               << " | aD: " << absoluteDistance);
-        m_curve.push_back({point, t, relativeDistance, absoluteDistance});
+        t0 = t1;
+        p0 = p1;
     }
 
+    NS_LOG_INFO("Generated curve with " << m_curve.size() << " points within "
+                                        << m_tolerance << " m.");
+    return m_curve.back().GetAbsoluteDistance();
+}
+
+void
+Curve::Subdivide(const float t0, const Vector& p0, const float t1, const Vector& p1) const
+{
+    const float tm = 0.5f * (t0 + t1);
+    const Vector pm = GetPoint(tm);
+
+    // distance of the midpoint of the curve from the chord
+    const Vector chord = p1 - p0;
+    const Vector offset = pm - p0;
+    const double chordLength2 = chord.x * chord.x + chord.y * chord.y + chord.z * chord.z;
+    const double projection =
+        (chordLength2 > 0.0)
+            ? std::clamp((offset.x * chord.x + offset.y * chord.y + offset.z * chord.z) /
+                             chordLength2,
+                         0.0,
+                         1.0)
+            : 0.0;
+    const Vector closest{p0.x + chord.x * projection,
+                         p0.y + chord.y * projection,
+                         p0.z + chord.z * projection};
+    const double error = CalculateDistance(pm, closest);
+
+    if (error > m_tolerance && (t1 - t0) > m_step && tm > t0 && tm < t1)
+    {
+        Subdivide(t0, p0, tm, pm);
+        Subdivide(tm, pm, t1, p1);
+    }
+    else
+    {
+        Append(p1, t1);
+    }
+}
+
+const double
+Curve::Append(const Vector& point, const float t) const
+{
+    double relativeDistance = 0.0;
+    double absoluteDistance = 0.0;
+
+    if (!m_curve.empty())
+    {
+        relativeDistance = m_curve.back().GetRelativeDistance(point);
+        absoluteDistance = m_curve.back().GetAbsoluteDistance() + relativeDistance;
+    }
+
+    NS_LOG_LOGIC("  NP:  " << point << " | t: " << t << " | rD: " << relativeDistance
+                           << " | aD: " << absoluteDistance);
+    m_curve.push_back({point, t, relativeDistance, absoluteDistance});
+
     return absoluteDistance;
 }
 
+size_t
+Curve::FindSegment(const double distance) const
+{
+    if (m_curve.size() < 2)
+        return m_curve.size();
+
+    // points are sorted by absolute distance, as it is accumulated during generation
+    const auto i = std::upper_bound(m_curve.begin() + 1,
+                                    m_curve.end(),
+                                    distance,
+                                    [](const double d, const CurvePoint& p) {
+                                        return d < p.GetAbsoluteDistance();
+                                    });
+
+    return std::distance(m_curve.begin(), i);
+}
+
+const Vector
+Curve::GetPositionAt(const double distance) const
+{
+    if (m_curve.empty())
+        return (m_knots.GetN() > 0) ? m_knots.GetFront()->GetPosition() : Vector();
+
+    const size_t i = FindSegment(distance);
+    if (i >= m_curve.size())
+        return m_curve.back().GetPosition();
+
+    const auto& from = m_curve[i - 1];
+    const auto& to = m_curve[i];
+    const double segmentLength = to.GetAbsoluteDistance() - from.GetAbsoluteDistance();
+    const double f = (segmentLength > 0.0)
+                         ? std::max(0.0, distance - from.GetAbsoluteDistance()) / segmentLength
+                         : 0.0;
+    const Vector p0 = from.GetPosition();
+    const Vector p1 = to.GetPosition();
+
+    return {p0.x + (p1.x - p0.x) * f, p0.y + (p1.y - p0.y) * f, p0.z + (p1.z - p0.z) * f};
+}
+
+const Vector
+Curve::GetDirectionAt(const double distance) const
+{
+    if (m_curve.size() < 2)
+        return Vector();
+
+    const size_t i = std::min(FindSegment(distance), m_curve.size() - 1);
+    const Vector direction = m_curve[i].GetRelativeDistanceVector(m_curve[i - 1]);
+    const double norm = m_curve[i].GetRelativeDistance(m_curve[i - 1]);
+
+    if (norm == 0.0)
+        return Vector();
+
+    return {direction.x / norm, direction.y / norm, direction.z / norm};
+}
+
 const Vector
 Curve::GetPoint(const float& t) const
 {
-    const uint32_t n = m_knots.GetN();
-    const uint32_t r = n - 1;
+    const size_t n = m_knotPositions.size();
 
-    Vector p{0.0, 0.0, 0.0};
+    if (n == 0)
+        return Vector();
+    else if (t <= 0.0 || n == 1)
+        return m_knotPositions.front();
+    else if (t >= 1.0)
+        return m_knotPositions.back();
 
-    const double fac_r = Factorial(r);
+    const size_t r = n - 1;
+    const double logT = std::log(t);
+    const double log1mT = std::log1p(-t);
 
-    for (uint32_t i = 0; i < n; i++)
+    Vector p{0.0, 0.0, 0.0};
+    double weights = 0.0;
+
+    for (size_t i = 0; i < n; i++)
     {
-        const double fact = fac_r / (Factorial(r - i) * Factorial(i));
-        const double pdiff = pow(1 - t, r - i);
-        const double power = pow(t, i);
-        const auto k = m_knots.Get(i)->GetPosition();
-
-        p.x += fact * pdiff * power * k.x;
-        p.y += fact * pdiff * power * k.y;
-        p.z += fact * pdiff * power * k.z;
+        // C(r, i) * t^i * (1 - t)^(r - i), that would overflow or underflow if evaluated directly
+        const double w = std::exp(m_logBinomials[i] + i * logT + (r - i) * log1mT);
+        const auto& k = m_knotPositions[i];
+
+        p.x += w * k.x;
+        p.y += w * k.y;
+        p.z += w * k.z;
+        weights += w;
     }
 
+    // weights sum to 1, normalize to cancel rounding errors
+    p.x /= weights;
+    p.y /= weights;
+    p.z /= weights;
+
     // NS_LOG_LOGIC ("Curve at t " << t << ": " << p);
     return p;
 }
 
-const double
-Curve::Factorial(const double x) const
-{
-    return (x == 0) || (x == 1) ? 1 : x * Factorial(x - 1);
-}
-
 } // namespace ns3
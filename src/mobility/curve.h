@@ -23,7 +23,9 @@
 
 #include <ns3/vector.h>
 
+#include <cstddef>
 #include <deque>
+#include <string>
 #include <vector>
 
 namespace ns3
@@ -40,8 +42,20 @@ class Curve
 
     /**
      * \brief the constructor requesting all the needed parameters.
+     *
+     * \param knots     the flight plan.
+     * \param step      the step of the curve parameter. With a tolerance, it is
+     *                  the smallest step that adaptive sampling may take.
+     * \param tolerance the maximum distance, in meters, between the curve and
+     *                  the chord joining two consecutive points. If zero, the
+     *                  curve is sampled uniformly at the given step.
+     * \param cacheDirectory the directory of the persistent curve cache, see
+     *                  CurveCache, or empty to always generate the curve.
      */
-    Curve(const FlightPlan knots, const float step);
+    Curve(const FlightPlan knots,
+          const float step,
+          const double tolerance = 0.0,
+          const std::string& cacheDirectory = "");
     /**
      * \brief the constructor requesting only the flight plan. The step will be
      *        1/100.
@@ -60,10 +74,47 @@ class Curve
      */
     const double Generate() const;
 
+    /**
+     * \return the number of points of the generated curve.
+     */
+    size_t GetN() const;
+
+    /**
+     * \brief Find the segment of the curve containing a given distance from
+     *        its origin, using a binary search over the absolute distances of
+     *        the points.
+     *
+     * \param distance the distance along the curve.
+     * \return the index of the first point farther than the distance, i.e.,
+     *         the end of the segment, or the number of points if the distance
+     *         is beyond the last one.
+     */
+    size_t FindSegment(const double distance) const;
+    /**
+     * \brief Get the point at a given distance from the origin of the curve,
+     *        interpolating linearly between the two points that bracket it.
+     *
+     * \param distance the distance along the curve.
+     * \return the point in space, clamped to the ends of the curve.
+     */
+    const Vector GetPositionAt(const double distance) const;
+    /**
+     * \brief Get the direction of the curve at a given distance from its origin.
+     *
+     * \param distance the distance along the curve.
+     * \return the unit vector of the segment containing the distance, or a
+     *         null vector if the curve has no length.
+     */
+    const Vector GetDirectionAt(const double distance) const;
+
   protected:
     /**
      * \brief Calculate the point of a curve given using Bézier generator.
      *
+     * The Bernstein weights are evaluated in logarithmic space from the
+     * precomputed binomial coefficients, in O(n) for n virtual knots, so that
+     * flight plans with hundreds of knots neither overflow nor underflow.
+     *
      * \param t the parameter needed by Bézier general equation, a float between
      *          0 and 1.
      * \return the point in the curve.
@@ -71,19 +122,52 @@ class Curve
     const Vector GetPoint(const float& t) const;
 
     /**
-     * \brief Helper function to calculate the factorial of a number using
-     *        standard facilities.
+     * \brief Sample the curve uniformly at the given step.
      *
-     * \param x the integer for which is needed it's factorial
-     * \reutrn x!
+     * \return the length of the newly generated curve.
+     */
+    const double GenerateUniform() const;
+
+    /**
+     * \brief Sample the curve adaptively, subdividing the interval of the curve
+     *        parameter until the chord of each segment is within the tolerance.
+     *
+     * \return the length of the newly generated curve.
      */
-    const double Factorial(const double x) const;
+    const double GenerateAdaptive() const;
+
+    /**
+     * \brief Recursively subdivide a segment of the curve, appending the points
+     *        after its first one.
+     *
+     * \param t0 the curve parameter of the first point of the segment.
+     * \param p0 the first point of the segment.
+     * \param t1 the curve parameter of the last point of the segment.
+     * \param p1 the last point of the segment.
+     */
+    void Subdivide(const float t0, const Vector& p0, const float t1, const Vector& p1) const;
+
+    /**
+     * \brief Append a point to the curve, accumulating its distance from the
+     *        origin.
+     *
+     * \param point the point in space.
+     * \param t     the curve parameter of the point.
+     * \return the absolute distance of the point.
+     */
+    const double Append(const Vector& point, const float t) const;
 
     mutable std::vector<CurvePoint> m_curve; /// The ordered set of points
                                              /// representing the curve.
     FlightPlan m_knots; /// Flight plan (as in virtual knots) used to generate the curve.
     size_t m_knotsN;    /// Number of real knots being used to generate the curve.
     float m_step;       /// Step of the curve.
+    double m_tolerance; /// Chord tolerance for adaptive sampling, or zero.
+    std::string m_cacheDirectory; /// Directory of the curve cache, or empty.
+
+    std::vector<Vector> m_knotPositions; /// Positions of the virtual knots.
+    std::vector<double> m_logBinomials;  /// Natural logarithm of the binomial
+                                         /// coefficients of the curve degree.
 };
 
 } // namespace ns3
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "geocentric-position-cache.h"
+
+#include <ns3/abort.h>
+#include <ns3/angles.h>
+#include <ns3/log.h>
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("GeocentricPositionCache");
+
+TopocentricFrame::TopocentricFrame()
+    : m_valid{false},
+      m_earthType{GeographicPositions::EarthSpheroidType::WGS84},
+      m_sinPhi{0.0},
+      m_cosPhi{1.0},
+      m_sinLambda{0.0},
+      m_cosLambda{1.0}
+{
+}
+
+TopocentricFrame::TopocentricFrame(const Vector& reference,
+                                   GeographicPositions::EarthSpheroidType earthType)
+    : m_valid{true},
+      m_reference{reference},
+      m_earthType{earthType},
+      m_origin{GeographicPositions::GeographicToCartesianCoordinates(reference.x,
+                                                                     reference.y,
+                                                                     reference.z,
+                                                                     earthType)}
+{
+    NS_LOG_FUNCTION(this << reference << earthType);
+
+    const double phi = DegreesToRadians(reference.x);
+    const double lambda = DegreesToRadians(reference.y);
+
+    m_sinPhi = std::sin(phi);
+    m_cosPhi = std::cos(phi);
+    m_sinLambda = std::sin(lambda);
+    m_cosLambda = std::cos(lambda);
+}
+
+bool
+TopocentricFrame::IsCenteredOn(const Vector& reference,
+                               GeographicPositions::EarthSpheroidType earthType) const
+{
+    return m_valid && m_reference == reference && m_earthType == earthType;
+}
+
+Vector
+TopocentricFrame::Convert(const Vector& geocentric) const
+{
+    const Vector d = geocentric - m_origin;
+
+    return {-m_sinLambda * d.x + m_cosLambda * d.y,
+            -m_sinPhi * m_cosLambda * d.x - m_sinPhi * m_sinLambda * d.y + m_cosPhi * d.z,
+            m_cosPhi * m_cosLambda * d.x + m_cosPhi * m_sinLambda * d.y + m_sinPhi * d.z};
+}
+
+GeocentricPositionCache::GeocentricPositionCache()
+{
+    m_valid.fill(false);
+}
+
+void
+GeocentricPositionCache::SetGeographic(const Vector& position)
+{
+    m_valid.fill(false);
+    m_positions[static_cast<size_t>(PositionType::GEOGRAPHIC)] = position;
+    m_valid[static_cast<size_t>(PositionType::GEOGRAPHIC)] = true;
+}
+
+void
+GeocentricPositionCache::SetProjected(const Vector& position)
+{
+    m_valid.fill(false);
+    m_positions[static_cast<size_t>(PositionType::PROJECTED)] = position;
+    m_valid[static_cast<size_t>(PositionType::PROJECTED)] = true;
+}
+
+Vector
+GeocentricPositionCache::Get(PositionType type,
+                             const Vector& reference,
+                             GeographicPositions::EarthSpheroidType earthType)
+{
+    const size_t i = static_cast<size_t>(type);
+    NS_ABORT_MSG_IF(i >= N_TYPES, "Unknown PositionType requested");
+
+    if (m_valid[i])
+        return m_positions[i];
+
+    // every type is derived from the geographic coordinates, that derive from projected ones
+    const size_t geographic = static_cast<size_t>(PositionType::GEOGRAPHIC);
+    if (!m_valid[geographic])
+    {
+        m_positions[geographic] = GeographicPositions::ProjectedToGeographicCoordinates(
+            m_positions[static_cast<size_t>(PositionType::PROJECTED)],
+            earthType);
+        m_valid[geographic] = true;
+    }
+
+    const Vector& position = m_positions[geographic];
+
+    switch (type)
+    {
+    case PositionType::TOPOCENTRIC:
+        if (!m_frame.IsCenteredOn(reference, earthType))
+            m_frame = TopocentricFrame(reference, earthType);
+        m_positions[i] = m_frame.Convert(Get(PositionType::GEOCENTRIC, reference, earthType));
+        break;
+    case PositionType::GEOCENTRIC:
+        m_positions[i] = GeographicPositions::GeographicToCartesianCoordinates(position.x,
+                                                                               position.y,
+                                                                               position.z,
+                                                                               earthType);
+        break;
+    case PositionType::PROJECTED:
+        m_positions[i] = GeographicPositions::GeographicToProjectedCoordinates(position, earthType);
+        break;
+    case PositionType::GEOGRAPHIC:
+    default:
+        break;
+    }
+
+    m_valid[i] = true;
+    return m_positions[i];
+}
+
+std::vector<Vector>
+GeocentricPositionCache::ProjectedToGeographicCoordinates(
+    const std::vector<Vector>& positions,
+    GeographicPositions::EarthSpheroidType earthType)
+{
+    NS_LOG_FUNCTION(positions.size() << earthType);
+
+    std::vector<Vector> out;
+    out.reserve(positions.size());
+    for (const auto& p : positions)
+        out.push_back(GeographicPositions::ProjectedToGeographicCoordinates(p, earthType));
+
+    return out;
+}
+
+std::vector<Vector>
+GeocentricPositionCache::GeographicToProjectedCoordinates(
+    const std::vector<Vector>& positions,
+    GeographicPositions::EarthSpheroidType earthType)
+{
+    NS_LOG_FUNCTION(positions.size() << earthType);
+
+    std::vector<Vector> out;
+    out.reserve(positions.size());
+    for (const auto& p : positions)
+        out.push_back(GeographicPositions::GeographicToProjectedCoordinates(p, earthType));
+
+    return out;
+}
+
+std::vector<Vector>
+GeocentricPositionCache::GeographicToTopocentricCoordinates(
+    const std::vector<Vector>& positions,
+    const Vector& reference,
+    GeographicPositions::EarthSpheroidType earthType)
+{
+    NS_LOG_FUNCTION(positions.size() << reference << earthType);
+
+    const TopocentricFrame frame(reference, earthType);
+
+    std::vector<Vector> out;
+    out.reserve(positions.size());
+    for (const auto& p : positions)
+    {
+        out.push_back(frame.Convert(
+            GeographicPositions::GeographicToCartesianCoordinates(p.x, p.y, p.z, earthType)));
+    }
+
+    return out;
+}
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (C) 2018-2024 The IoD_Sim Authors.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef GEOCENTRIC_POSITION_CACHE_H
+#define GEOCENTRIC_POSITION_CACHE_H
+
+#include <ns3/geocentric-mobility-model.h>
+#include <ns3/geographic-positions.h>
+#include <ns3/vector.h>
+
+#include <array>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mobility
+ * \brief The East-North-Up frame centered on a geographic reference point, with its rotation
+ *        precomputed to convert many geocentric positions without trigonometry.
+ */
+class TopocentricFrame
+{
+  public:
+    TopocentricFrame();
+
+    /**
+     * \param reference the geographic reference point, i.e., latitude, longitude and altitude.
+     * \param earthType the Earth spheroid.
+     */
+    TopocentricFrame(const Vector& reference, GeographicPositions::EarthSpheroidType earthType);
+
+    /**
+     * \param reference the geographic reference point.
+     * \param earthType the Earth spheroid.
+     * \return whether the frame is centered on the reference point, for the given spheroid.
+     */
+    bool IsCenteredOn(const Vector& reference,
+                      GeographicPositions::EarthSpheroidType earthType) const;
+
+    /**
+     * \brief Convert geocentric cartesian coordinates to topocentric ones, as
+     *        GeographicPositions::GeographicToTopocentricCoordinates does.
+     *
+     * \param geocentric the geocentric cartesian coordinates.
+     * \return the topocentric coordinates.
+     */
+    Vector Convert(const Vector& geocentric) const;
+
+  private:
+    bool m_valid;                                       ///< Whether the frame has been set
+    Vector m_reference;                                 ///< Geographic reference point
+    GeographicPositions::EarthSpheroidType m_earthType; ///< Earth spheroid
+    Vector m_origin;    ///< Geocentric coordinates of the reference point
+    double m_sinPhi;    ///< Sine of the latitude of the reference point
+    double m_cosPhi;    ///< Cosine of the latitude of the reference point
+    double m_sinLambda; ///< Sine of the longitude of the reference point
+    double m_cosLambda; ///< Cosine of the longitude of the reference point
+};
+
+/**
+ * \ingroup mobility
+ * \brief The position of a geocentric drone mobility model at the current time, converted
+ *        lazily to each PositionType and kept until the drone moves.
+ */
+class GeocentricPositionCache
+{
+  public:
+    GeocentricPositionCache();
+
+    /**
+     * \brief Set the position, from its geographic coordinates.
+     *
+     * \param position latitude, longitude and altitude.
+     */
+    void SetGeographic(const Vector& position);
+
+    /**
+     * \brief Set the position, from its projected coordinates.
+     *
+     * \param position the projected coordinates.
+     */
+    void SetProjected(const Vector& position);
+
+    /**
+     * \brief Get the position, converting it on the first request of each type.
+     *
+     * \param type      the requested coordinate system.
+     * \param reference the geographic reference point of topocentric coordinates.
+     * \param earthType the Earth spheroid.
+     * \return the position.
+     */
+    Vector Get(PositionType type,
+               const Vector& reference,
+               GeographicPositions::EarthSpheroidType earthType);
+
+    /**
+     * \brief Convert many projected positions to geographic coordinates.
+     *
+     * \param positions the projected coordinates.
+     * \param earthType the Earth spheroid.
+     * \return latitude, longitude and altitude of each position.
+     */
+    static std::vector<Vector> ProjectedToGeographicCoordinates(
+        const std::vector<Vector>& positions,
+        GeographicPositions::EarthSpheroidType earthType);
+
+    /**
+     * \brief Convert many geographic positions to projected coordinates.
+     *
+     * \param positions latitude, longitude and altitude of each position.
+     * \param earthType the Earth spheroid.
+     * \return the projected coordinates.
+     */
+    static std::vector<Vector> GeographicToProjectedCoordinates(
+        const std::vector<Vector>& positions,
+        GeographicPositions::EarthSpheroidType earthType);
+
+    /**
+     * \brief Convert many geographic positions to topocentric coordinates, computing the
+     *        frame of the reference point once.
+     *
+     * \param positions latitude, longitude and altitude of each position.
+     * \param reference the geographic reference point.
+     * \param earthType the Earth spheroid.
+     * \return the topocentric coordinates.
+     */
+    static std::vector<Vector> GeographicToTopocentricCoordinates(
+        const std::vector<Vector>& positions,
+        const Vector& reference,
+        GeographicPositions::EarthSpheroidType earthType);
+
+  private:
+    /// Number of supported position types
+    static constexpr size_t N_TYPES = 4;
+
+    std::array<Vector, N_TYPES> m_positions; ///< Position, for each type
+    std::array<bool, N_TYPES> m_valid;       ///< Whether the position of each type is known
+    TopocentricFrame m_frame;                ///< Frame of the last reference point
+};
+
+} // namespace ns3
+
+#endif /* GEOCENTRIC_POSITION_CACHE_H */
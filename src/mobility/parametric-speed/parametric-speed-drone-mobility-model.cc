@@ -20,10 +20,14 @@
 #include <ns3/boolean.h>
 #include <ns3/double-vector.h>
 #include <ns3/double.h>
+#include <ns3/enum.h>
 #include <ns3/integer.h>
 #include <ns3/log.h>
 #include <ns3/object-vector.h>
 #include <ns3/simulator.h>
+#include <ns3/string.h>
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -65,7 +69,59 @@ ParametricSpeedDroneMobilityModel::GetTypeId()
                           "generated, hence higher resolution.",
                           DoubleValue(0.001),
                           MakeDoubleAccessor(&ParametricSpeedDroneMobilityModel::m_curveStep),
-                          MakeDoubleChecker<float>());
+                          MakeDoubleChecker<float>())
+            .AddAttribute(
+                "CurveTolerance",
+                "The maximum distance, in meters, between the curve and the segments joining its "
+                "points. If positive, the curve is sampled adaptively, more densely on turns than "
+                "on straight legs, and CurveStep is the finest step. If zero, the curve is "
+                "sampled uniformly at CurveStep.",
+                DoubleValue(0.0),
+                MakeDoubleAccessor(&ParametricSpeedDroneMobilityModel::m_curveTolerance),
+                MakeDoubleChecker<double>(0.0))
+            .AddAttribute(
+                "CurveCacheDirectory",
+                "Directory of a persistent cache of generated curves, shared by simulations "
+                "running the same flight plans. Curves are looked up by a hash of their knots, "
+                "CurveStep and CurveTolerance, and generated and stored only if missing. If "
+                "empty, curves are always generated.",
+                StringValue(""),
+                MakeStringAccessor(&ParametricSpeedDroneMobilityModel::m_curveCacheDirectory),
+                MakeStringChecker())
+            .AddAttribute(
+                "CourseChangeNotification",
+                "When to notify the CourseChange trace. ON_QUERY notifies whenever the position "
+                "or velocity is queried at a new time, as queries from channels or energy models "
+                "are frequent. ON_SEGMENT_CHANGE notifies when the drone starts a new flight or "
+                "rest. PERIODIC samples the drone every CourseChangePeriod and notifies if it "
+                "moved. ON_DISPLACEMENT samples the drone every CourseChangePeriod and notifies "
+                "if it moved more than CourseChangeDistance, started or stopped. Except with "
+                "ON_QUERY, queries have no side effects.",
+                EnumValue(CourseChangeNotificationType::PERIODIC),
+                MakeEnumAccessor<CourseChangeNotificationType>(
+                    &ParametricSpeedDroneMobilityModel::m_courseChangeNotification),
+                MakeEnumChecker<CourseChangeNotificationType>(
+                    CourseChangeNotificationType::ON_QUERY,
+                    "ON_QUERY",
+                    CourseChangeNotificationType::ON_SEGMENT_CHANGE,
+                    "ON_SEGMENT_CHANGE",
+                    CourseChangeNotificationType::PERIODIC,
+                    "PERIODIC",
+                    CourseChangeNotificationType::ON_DISPLACEMENT,
+                    "ON_DISPLACEMENT"))
+            .AddAttribute(
+                "CourseChangePeriod",
+                "Sampling period of the PERIODIC and ON_DISPLACEMENT CourseChange notifications.",
+                TimeValue(MilliSeconds(100)),
+                MakeTimeAccessor(&ParametricSpeedDroneMobilityModel::m_courseChangePeriod),
+                MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute(
+                "CourseChangeDistance",
+                "Displacement, in meters, that triggers ON_DISPLACEMENT CourseChange "
+                "notifications.",
+                DoubleValue(1.0),
+                MakeDoubleAccessor(&ParametricSpeedDroneMobilityModel::m_courseChangeDistance),
+                MakeDoubleChecker<double>(0.0));
 
     return tid;
 }
@@ -84,15 +140,22 @@ ParametricSpeedDroneMobilityModel::ProjectedToGeographicCoordinates(
 {
     NS_LOG_FUNCTION(flightPlan << earthType);
 
+    std::vector<Vector> positions;
+    positions.reserve(flightPlan.GetN());
+    for (const auto& point : flightPlan)
+        positions.push_back(point->GetPosition());
+
+    const auto converted =
+        GeocentricPositionCache::ProjectedToGeographicCoordinates(positions, earthType);
+
     FlightPlan fpOut;
+    auto geographicPositionIt = converted.begin();
     for (const auto& point : flightPlan)
     {
-        const auto geographicPosition =
-            GeographicPositions::ProjectedToGeographicCoordinates(point->GetPosition(), earthType);
         NS_LOG_LOGIC("Translated position from Projected "
-                     << point->GetPosition() << " to Geographic " << geographicPosition);
+                     << point->GetPosition() << " to Geographic " << *geographicPositionIt);
         auto p = CreateObjectWithAttributes<ProtoPoint>("Position",
-                                                        VectorValue(geographicPosition),
+                                                        VectorValue(*geographicPositionIt++),
                                                         "Interest",
                                                         IntegerValue(point->GetInterest()),
                                                         "RestTime",
@@ -110,15 +173,22 @@ ParametricSpeedDroneMobilityModel::GeographicToProjectedCoordinates(
 {
     NS_LOG_FUNCTION(flightPlan << earthType);
 
+    std::vector<Vector> positions;
+    positions.reserve(flightPlan.GetN());
+    for (const auto& point : flightPlan)
+        positions.push_back(point->GetPosition());
+
+    const auto converted =
+        GeocentricPositionCache::GeographicToProjectedCoordinates(positions, earthType);
+
     FlightPlan fpOut;
+    auto projectedPositionIt = converted.begin();
     for (const auto& point : flightPlan)
     {
-        const auto projectedPosition =
-            GeographicPositions::GeographicToProjectedCoordinates(point->GetPosition(), earthType);
         NS_LOG_LOGIC("Translated position from Geographic "
-                     << point->GetPosition() << " to Projected " << projectedPosition);
+                     << point->GetPosition() << " to Projected " << *projectedPositionIt);
         auto p = CreateObjectWithAttributes<ProtoPoint>("Position",
-                                                        VectorValue(projectedPosition),
+                                                        VectorValue(*projectedPositionIt++),
                                                         "Interest",
                                                         IntegerValue(point->GetInterest()),
                                                         "RestTime",
@@ -139,7 +209,13 @@ ParametricSpeedDroneMobilityModel::DoInitialize()
                        : m_flightPlan;
     m_planner = Planner<ParametricSpeedParam, ParametricSpeedFlight>(m_flightPlan,
                                                                      m_flightParams,
-                                                                     m_curveStep);
+                                                                     m_curveStep,
+                                                                     m_curveTolerance,
+                                                                     m_curveCacheDirectory);
+
+    if (m_courseChangeNotification != CourseChangeNotificationType::ON_QUERY)
+        m_courseChangeEvent =
+            Simulator::ScheduleNow(&ParametricSpeedDroneMobilityModel::DoCourseChange, this, true);
 }
 
 void
@@ -147,41 +223,23 @@ ParametricSpeedDroneMobilityModel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
 
+    m_courseChangeEvent.Cancel();
+
     MobilityModel::DoDispose();
 }
 
 Vector
 ParametricSpeedDroneMobilityModel::DoGetPosition(PositionType type) const
 {
-    NS_LOG_FUNCTION(this);
-    NS_LOG_LOGIC("position before update: " << m_position);
+    NS_LOG_FUNCTION(this << type);
+
     Update();
-    NS_LOG_LOGIC("position after update: " << m_position);
 
     if (!m_useGeodedicSystem)
         return m_position;
 
-    switch (type)
-    {
-    case PositionType::TOPOCENTRIC:
-        return GeographicPositions::GeographicToTopocentricCoordinates(
-            m_position,
-            GetGeographicReferencePoint(),
-            GetEarthSpheroidType());
-    case PositionType::GEOCENTRIC:
-        return GeographicPositions::GeographicToCartesianCoordinates(m_position.x,
-                                                                     m_position.y,
-                                                                     m_position.z,
-                                                                     GetEarthSpheroidType());
-    case PositionType::PROJECTED:
-        return GeographicPositions::GeographicToProjectedCoordinates(m_position,
-                                                                     GetEarthSpheroidType());
-    case PositionType::GEOGRAPHIC:
-    default:
-        return m_position;
-    }
-
-    return m_position;
+    // conversions are computed once per update, as every query of the same type would repeat them
+    return m_positionCache.Get(type, GetGeographicReferencePoint(), GetEarthSpheroidType());
 }
 
 void
@@ -220,6 +278,8 @@ ParametricSpeedDroneMobilityModel::DoSetPosition(const Vector& position, Positio
         NS_ASSERT_MSG((m_position.y >= -180) && (m_position.y <= 180),
                       "Longitude must be between -180 deg and +180 deg");
         NS_ASSERT_MSG(m_position.z >= 0, "Altitude must be higher or equal 0 meters");
+
+        m_positionCache.SetGeographic(m_position);
     }
     else
     {
@@ -255,14 +315,77 @@ ParametricSpeedDroneMobilityModel::Update() const
     m_lastUpdate = t;
 
     m_planner.Update(t);
-    m_position =
-        (m_useGeodedicSystem)
-            ? GeographicPositions::ProjectedToGeographicCoordinates(m_planner.GetPosition(),
-                                                                    GetEarthSpheroidType())
-            : m_planner.GetPosition();
+    if (m_useGeodedicSystem)
+    {
+        // geographic coordinates are converted on demand, as only projected ones may be needed
+        m_positionCache.SetProjected(m_planner.GetPosition());
+    }
+    else
+    {
+        m_position = m_planner.GetPosition();
+    }
     m_velocity = m_planner.GetVelocity();
 
-    NotifyCourseChange();
+    if (m_courseChangeNotification == CourseChangeNotificationType::ON_QUERY)
+        NotifyCourseChange();
+}
+
+void
+ParametricSpeedDroneMobilityModel::ScheduleCourseChange()
+{
+    NS_LOG_FUNCTION(this);
+
+    const Time now = Simulator::Now();
+    const Time next =
+        (m_courseChangeNotification == CourseChangeNotificationType::ON_SEGMENT_CHANGE)
+            ? m_planner.GetNextTimeWindowStart(now)
+            : std::min(now + m_courseChangePeriod, m_planner.GetNextTimeWindowStart(now));
+
+    // the drone stands still after the end of the flight plan
+    if (next <= now)
+        return;
+
+    m_courseChangeEvent =
+        Simulator::Schedule(next - now,
+                            &ParametricSpeedDroneMobilityModel::DoCourseChange,
+                            this,
+                            false);
+}
+
+void
+ParametricSpeedDroneMobilityModel::DoCourseChange(const bool force)
+{
+    NS_LOG_FUNCTION(this);
+
+    Update();
+
+    const Vector position = m_planner.GetPosition();
+    bool notify = true;
+
+    if (force)
+    {
+        NS_LOG_LOGIC("Notifying the initial position.");
+    }
+    else if (m_courseChangeNotification == CourseChangeNotificationType::PERIODIC)
+    {
+        notify = position != m_notifiedPosition || m_velocity != m_notifiedVelocity;
+    }
+    else if (m_courseChangeNotification == CourseChangeNotificationType::ON_DISPLACEMENT)
+    {
+        const bool wasMoving = m_notifiedVelocity != Vector();
+        const bool isMoving = m_velocity != Vector();
+        notify = CalculateDistance(position, m_notifiedPosition) >= m_courseChangeDistance ||
+                 wasMoving != isMoving;
+    }
+
+    if (notify)
+    {
+        m_notifiedPosition = position;
+        m_notifiedVelocity = m_velocity;
+        NotifyCourseChange();
+    }
+
+    ScheduleCourseChange();
 }
 
 FlightPlan
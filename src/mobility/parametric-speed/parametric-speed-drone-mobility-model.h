@@ -22,12 +22,17 @@
 #include "parametric-speed-param.h"
 
 #include <ns3/double-vector.h>
+#include <ns3/event-id.h>
 #include <ns3/flight-plan.h>
 #include <ns3/geocentric-mobility-model.h>
+#include <ns3/geocentric-position-cache.h>
+#include <ns3/nstime.h>
 #include <ns3/planner.h>
 #include <ns3/proto-point.h>
 #include <ns3/vector.h>
 
+#include <string>
+
 namespace ns3
 {
 
@@ -64,6 +69,14 @@ class ParametricSpeedDroneMobilityModel : public GeocentricMobilityModel
     virtual Vector DoGetVelocity() const;
 
     virtual void Update() const;
+    /// Schedule the next evaluation of the CourseChange notification policy.
+    void ScheduleCourseChange();
+    /**
+     * \brief Update the drone and notify CourseChange if required by the notification policy.
+     *
+     * \param force whether to notify regardless of the policy.
+     */
+    void DoCourseChange(const bool force);
     FlightPlan GetFlightPlan() const;
     void SetFlightPlan(const FlightPlan& fp);
 
@@ -72,6 +85,7 @@ class ParametricSpeedDroneMobilityModel : public GeocentricMobilityModel
   protected:
     mutable Vector m_position;
     mutable Vector m_velocity;
+    mutable GeocentricPositionCache m_positionCache; /// Geodetic conversions of the position
 
     FlightPlan m_flightPlan;
     ParametricSpeedParam m_flightParams;
@@ -80,6 +94,15 @@ class ParametricSpeedDroneMobilityModel : public GeocentricMobilityModel
     mutable Time m_lastUpdate;
 
     float m_curveStep;
+    double m_curveTolerance;
+    std::string m_curveCacheDirectory;
+
+    CourseChangeNotificationType m_courseChangeNotification;
+    Time m_courseChangePeriod;
+    double m_courseChangeDistance;
+    EventId m_courseChangeEvent;
+    Vector m_notifiedPosition; /// Projected position of the last notification
+    Vector m_notifiedVelocity; /// Velocity of the last notification
     bool m_useGeodedicSystem;
 };
 
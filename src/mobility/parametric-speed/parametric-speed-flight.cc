@@ -17,41 +17,62 @@
  */
 #include "parametric-speed-flight.h"
 
+#include <ns3/abort.h>
 #include <ns3/log.h>
 #include <ns3/simulator.h>
 
+#include <algorithm>
 #include <cmath>
-#include <gsl/gsl_errno.h>
-#include <gsl/gsl_integration.h>
-#include <gsl/gsl_math.h>
-#include <gsl/gsl_roots.h>
-#include <iomanip>
 
 namespace ns3
 {
 
-class PrivFuncParams
+NS_LOG_COMPONENT_DEFINE("ParametricSpeedFlight");
+
+/**
+ * Evaluate a polynomial using Horner's method.
+ *
+ * \param coeffs the coefficients of the polynomial, from the highest degree.
+ * \param x      the point where to evaluate the polynomial.
+ * \return the value of the polynomial.
+ */
+static double
+Horner(const std::vector<double>& coeffs, const double x)
 {
-  public:
-    PrivFuncParams(std::vector<double> coeffs, std::vector<double> coeffsDeriv);
-    PrivFuncParams(std::vector<double> coeffs);
-    ~PrivFuncParams();
+    double y = 0.0;
 
-    std::vector<double> GetCoeffs();
-    std::vector<double> GetCoeffsDeriv();
+    for (const auto& c : coeffs)
+        y = y * x + c;
 
-  private:
-    std::vector<double> m_coeffs;
-    std::vector<double> m_coeffsDeriv;
-};
+    return y;
+}
 
-NS_LOG_COMPONENT_DEFINE("ParametricSpeedFlight");
+/**
+ * Integrate a polynomial, with zero as constant term.
+ *
+ * \param coeffs the coefficients of the polynomial, from the highest degree.
+ * \return the coefficients of its integral, from the highest degree.
+ */
+static std::vector<double>
+Integrate(const std::vector<double>& coeffs)
+{
+    const size_t order = coeffs.size(); // order of the polynomial, plus 1
+    std::vector<double> integral(order + 1, 0.0);
+
+    for (size_t i = 0; i < order; i++)
+        integral[i] = coeffs[i] / (order - i);
+
+    return integral;
+}
 
 ParametricSpeedFlight::ParametricSpeedFlight(FlightPlan flightPlan,
                                              ParametricSpeedParam speedParams,
-                                             double step)
-    : Curve(flightPlan, step),
+                                             double step,
+                                             double tolerance,
+                                             const std::string& cacheDirectory)
+    : Curve(flightPlan, step, tolerance, cacheDirectory),
       m_speedParams{speedParams.GetSpeedCoefficients()},
+      m_distanceParams{Integrate(m_speedParams)},
       m_isHovering{flightPlan.GetN() == 1}
 {
     Generate();
@@ -66,19 +87,18 @@ ParametricSpeedFlight::Generate()
     {
         // this is a dummy flight plan to hover on a specific point.
         m_length = 0;
-        m_currentVelocity = Vector3D();
         m_time = m_knots.GetBack()->GetRestTime();
     }
     else
     {
         m_length = Curve::Generate();
-        m_currentPositionPtr = m_curve.begin();
         m_time = Seconds(FindTime());
 
         NS_LOG_LOGIC("Drone will take " << m_time << " to traverse the path.");
     }
 
-    m_currentPosition = CurvePoint(m_knots.GetFront()->GetPosition());
+    m_currentPosition = m_knots.GetFront()->GetPosition();
+    m_currentVelocity = Vector3D();
 }
 
 void
@@ -88,12 +108,10 @@ ParametricSpeedFlight::Update(const double& t) const
 
     if (!m_isHovering)
     {
-        UpdateSpeed(t);
-        UpdateDistance(t);
-        UpdatePosition();
-        UpdateVelocity();
+        m_currentPosition = GetPosition(t);
+        m_currentVelocity = GetVelocity(t);
 
-        NS_LOG_LOGIC("t: " << t << " speed: " << m_currentSpeed << " dist: " << m_currentDistance);
+        NS_LOG_LOGIC("t: " << t << " pos: " << m_currentPosition << " vel: " << m_currentVelocity);
     }
 }
 
@@ -106,7 +124,7 @@ ParametricSpeedFlight::GetTime() const
 Vector
 ParametricSpeedFlight::GetPosition() const
 {
-    return m_currentPosition.GetPosition();
+    return m_currentPosition;
 }
 
 Vector
@@ -115,109 +133,43 @@ ParametricSpeedFlight::GetVelocity() const
     return m_currentVelocity;
 }
 
-void
-ParametricSpeedFlight::UpdateSpeed(const double& t) const
-{
-    double speed = 0.0;
-    const uint32_t order = m_speedParams.size();
-
-    for (uint32_t i = 0; i < order; i++)
-        speed += m_speedParams[i] * std::pow(t, order - i - 1);
-
-    m_currentSpeed = speed;
-}
-
-void
-ParametricSpeedFlight::UpdateDistance(const double& t) const
-{
-    // analytic polynomial integration
-    double distance = 0.0;
-    const uint32_t orderp1 = m_speedParams.size(); // order of the polynomial, plus 1
-
-    for (uint32_t i = 0; i < orderp1; i++)
-        distance += m_speedParams[i] / (i + 1) * std::pow(t, i + 1);
-
-    m_currentDistance = distance;
-}
-
-void
-ParametricSpeedFlight::UpdatePosition() const
+double
+ParametricSpeedFlight::GetDistance(const double& t) const
 {
-    NS_LOG_FUNCTION_NOARGS();
-    NS_LOG_LOGIC("old pos vector: " << m_currentPosition.GetPosition());
-    m_pastPosition = m_currentPosition;
-
-    for (auto i = m_curve.begin(); i != m_curve.end(); i++)
-    {
-        if ((*i).GetAbsoluteDistance() > m_currentDistance)
-        {
-            m_currentPosition = (*i);
-            m_currentPositionPtr = i;
-            break;
-        }
-    }
-
-    NS_LOG_LOGIC("new pos vector: " << m_currentPosition.GetPosition());
+    return Horner(m_distanceParams, std::clamp(t, 0.0, m_time.GetSeconds()));
 }
 
-void
-ParametricSpeedFlight::UpdateVelocity() const
+double
+ParametricSpeedFlight::GetSpeed(const double& t) const
 {
-    NS_LOG_FUNCTION_NOARGS();
-    NS_LOG_LOGIC("old vel: " << m_currentVelocity);
-
-    const Vector relativeDistance = m_currentPosition.GetRelativeDistanceVector(m_pastPosition);
-    const double relativeDistScalar = m_currentPosition.GetRelativeDistance(m_pastPosition);
-
-    if (relativeDistScalar == 0.0)
-        return;
-
-    const double velX =
-        (relativeDistance.x != 0) ? (relativeDistance.x / relativeDistScalar) * m_currentSpeed : 0;
-    const double velY =
-        (relativeDistance.y != 0) ? (relativeDistance.y / relativeDistScalar) * m_currentSpeed : 0;
-    const double velZ =
-        (relativeDistance.z != 0) ? (relativeDistance.z / relativeDistScalar) * m_currentSpeed : 0;
-
-    NS_LOG_LOGIC("relative distance: " << relativeDistance
-                                       << "; current speed: " << m_currentSpeed);
-
-    m_currentVelocity = {velX, velY, velZ};
+    if (t < 0.0 || t > m_time.GetSeconds())
+        return 0.0;
 
-    NS_LOG_LOGIC("new vel: " << m_currentVelocity);
+    return Horner(m_speedParams, t);
 }
 
-double
-Quadratic(double x, void* params)
+Vector
+ParametricSpeedFlight::GetPosition(const double& t) const
 {
-    std::vector<double> coeffs = ((PrivFuncParams*)params)->GetCoeffs();
-    uint32_t order = coeffs.size() - 1;
-    double y = 0;
+    NS_LOG_FUNCTION(t);
 
-    for (uint32_t i = 0; i < coeffs.size(); i++)
-        y += coeffs[i] * std::pow(x, order - i);
+    if (m_isHovering)
+        return m_knots.GetFront()->GetPosition();
 
-    return y;
+    return GetPositionAt(GetDistance(t));
 }
 
-double
-QuadraticDeriv(double x, void* params)
+Vector
+ParametricSpeedFlight::GetVelocity(const double& t) const
 {
-    std::vector<double> coeffs = ((PrivFuncParams*)params)->GetCoeffsDeriv();
-    uint32_t order = coeffs.size() - 1;
-    double y = 0;
-
-    for (uint32_t i = 0; i < coeffs.size(); i++)
-        y += coeffs[i] * std::pow(x, order - i);
+    NS_LOG_FUNCTION(t);
 
-    return y;
-}
+    const double speed = m_isHovering ? 0.0 : GetSpeed(t);
+    if (speed == 0.0)
+        return Vector3D();
 
-void
-QuadraticFdf(double x, void* params, double* y, double* dy)
-{
-    *y = Quadratic(x, params);
-    *dy = QuadraticDeriv(x, params);
+    const Vector direction = GetDirectionAt(GetDistance(t));
+    return {direction.x * speed, direction.y * speed, direction.z * speed};
 }
 
 const double
@@ -229,90 +181,45 @@ ParametricSpeedFlight::FindTime() const
     if (m_length == 0.0)
         return 0.0;
 
-    uint32_t order = m_speedParams.size();
+    NS_LOG_LOGIC("Length: " << m_length);
 
-    // analytic polynomial integration
-    std::vector<double> coeffs = m_speedParams;
-    for (uint32_t i = 0; i < order; i++)
+    // bracket the root, doubling the upper bound until the whole path is traversed
+    double lo = 0.0;
+    double hi = 1.0;
+    for (uint32_t i = 0; Horner(m_distanceParams, hi) < m_length; i++)
     {
-        coeffs[i] /= order - i;
+        NS_ABORT_MSG_IF(i >= 64,
+                        "The speed of the drone does not allow to traverse a path of "
+                            << m_length << " m.");
+        lo = hi;
+        hi *= 2;
     }
-    coeffs.push_back(-m_length);
-
-    NS_LOG_LOGIC("Length: " << m_length);
-
-    /* setup GSL */
-    int status;
-    int iter = 0, max_iter = 1000;
-    const gsl_root_fdfsolver_type* T;
-    gsl_root_fdfsolver* s;
-    double x0, x = m_length; // x will be our root
-    gsl_function_fdf FDF;
-    PrivFuncParams params(coeffs, m_speedParams);
-
-    FDF.f = &Quadratic;
-    FDF.df = &QuadraticDeriv;
-    FDF.fdf = &QuadraticFdf;
-    FDF.params = &params;
 
-    T = gsl_root_fdfsolver_newton;
-    s = gsl_root_fdfsolver_alloc(T);
-    gsl_root_fdfsolver_set(s, &FDF, x);
-
-    NS_LOG_LOGIC("Using " << gsl_root_fdfsolver_name(s) << " method.");
-    NS_LOG_LOGIC("iter\t root");
-
-    do
+    // Newton-Raphson, falling back to bisection whenever it leaves the bracket
+    double x = hi;
+    for (uint32_t iter = 0; iter < 1000; iter++)
     {
-        iter++;
-        status = gsl_root_fdfsolver_iterate(s);
-        if (status != GSL_SUCCESS)
-            NS_LOG_ERROR(
-                "GSL Encountered and error when applying the Newton-Raphson method. Error code: "
-                << status);
-
-        x0 = x;
-        x = gsl_root_fdfsolver_root(s);
-        status = gsl_root_test_delta(x, x0, 0, 1e-3);
-
-        if (status == GSL_SUCCESS)
-            NS_LOG_LOGIC("Converged:");
-
-        NS_LOG_LOGIC(std::fixed << std::setw(4) << iter << "\t" << std::fixed << std::setw(10)
-                                << std::setprecision(7) << x);
-    } while (status == GSL_CONTINUE && iter < max_iter);
+        const double f = Horner(m_distanceParams, x) - m_length;
+        const double df = Horner(m_speedParams, x);
 
-    gsl_root_fdfsolver_free(s);
+        if (f > 0.0)
+            hi = x;
+        else
+            lo = x;
 
-    return std::abs(x);
-}
+        double next = (df > 0.0) ? x - f / df : 0.5 * (lo + hi);
+        if (next <= lo || next >= hi)
+            next = 0.5 * (lo + hi);
 
-PrivFuncParams::PrivFuncParams(std::vector<double> coeffs, std::vector<double> coeffsDeriv)
-    : m_coeffs{coeffs},
-      m_coeffsDeriv{coeffsDeriv}
-{
-}
+        NS_LOG_LOGIC("iter " << iter << ": " << next);
 
-PrivFuncParams::PrivFuncParams(std::vector<double> coeffs)
-    : m_coeffs{coeffs},
-      m_coeffsDeriv{}
-{
-}
-
-PrivFuncParams::~PrivFuncParams()
-{
-}
-
-std::vector<double>
-PrivFuncParams::GetCoeffs()
-{
-    return m_coeffs;
-}
+        const bool converged = std::abs(next - x) < 1e-9 * std::max(1.0, x);
+        x = next;
+        if (converged || lo == hi)
+            break;
+    }
 
-std::vector<double>
-PrivFuncParams::GetCoeffsDeriv()
-{
-    return m_coeffsDeriv;
+    return x;
 }
 
 } // namespace ns3
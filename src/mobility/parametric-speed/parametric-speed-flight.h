@@ -37,8 +37,16 @@ class ParametricSpeedFlight : public Curve
      *
      * \param flightPlan      The Flight Plan to construct the flight path.
      * \param speedParameters The coefficients to model the speed of the drone.
+     * \param step            The step of the curve.
+     * \param tolerance       The chord tolerance of the curve, in meters, or zero to sample it
+     *                        uniformly at the given step.
+     * \param cacheDirectory  The directory of the persistent curve cache, or empty to disable it.
      */
-    ParametricSpeedFlight(FlightPlan flightPlan, ParametricSpeedParam speedParams, double step);
+    ParametricSpeedFlight(FlightPlan flightPlan,
+                          ParametricSpeedParam speedParams,
+                          double step,
+                          double tolerance = 0.0,
+                          const std::string& cacheDirectory = "");
 
     void Generate();
     void Update(const double& time) const;
@@ -47,25 +55,48 @@ class ParametricSpeedFlight : public Curve
     Vector GetPosition() const;
     Vector GetVelocity() const;
 
+    /**
+     * \brief Evaluate the flight at a given time, regardless of any previous query.
+     *
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the position of the drone.
+     */
+    Vector GetPosition(const double& time) const;
+    /**
+     * \brief Evaluate the flight at a given time, regardless of any previous query.
+     *
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the velocity of the drone.
+     */
+    Vector GetVelocity(const double& time) const;
+    /**
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the distance travelled along the curve, i.e., the integral of the speed.
+     */
+    double GetDistance(const double& time) const;
+    /**
+     * \param time the time since the beginning of the flight, in seconds.
+     * \return the scalar speed of the drone.
+     */
+    double GetSpeed(const double& time) const;
+
   protected:
-    void UpdateDistance(const double& time) const;
-    void UpdateSpeed(const double& time) const;
-    void UpdatePosition() const;
-    void UpdateVelocity() const;
+    /**
+     * \brief Solve distance(t) = length, bracketing the root and refining it with a safeguarded
+     *        Newton method.
+     *
+     * \return the time the drone takes to traverse the whole path, in seconds.
+     */
     const double FindTime() const;
 
-    mutable CurvePoint m_currentPosition;
-    mutable Curve::Iterator m_currentPositionPtr;
-    mutable CurvePoint m_pastPosition;
-    mutable double m_currentDistance;
-
+    mutable Vector m_currentPosition;
     mutable Vector m_currentVelocity;
-    mutable double m_currentSpeed;
 
     double m_length; /// Total length of the flight path
     Time m_time;     /// Total time the drone would take to complete it
 
-    std::vector<double> m_speedParams;
+    std::vector<double> m_speedParams;    /// Speed polynomial, from the highest degree
+    std::vector<double> m_distanceParams; /// Its integral, from the highest degree
     bool m_isHovering;
 };
 
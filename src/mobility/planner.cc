@@ -23,17 +23,29 @@
 #include <ns3/parametric-speed-flight.h>
 #include <ns3/parametric-speed-param.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE_MASK("Planner", LOG_PREFIX_ALL);
 
+template <typename FlightParam, typename FlightType>
+Planner<FlightParam, FlightType>::Planner()
+    : m_cursor{0}
+{
+}
+
 template <typename FlightParam, typename FlightType>
 Planner<FlightParam, FlightType>::Planner(FlightPlan flightPlan,
                                           FlightParam flightParam,
-                                          float step)
+                                          float step,
+                                          double tolerance,
+                                          const std::string& cacheDirectory)
     : m_step{step},
-      m_flightParams{flightParam}
+      m_flightParams{flightParam},
+      m_cursor{0}
 {
     for (auto& point : flightPlan)
     {
@@ -52,7 +64,7 @@ Planner<FlightParam, FlightType>::Planner(FlightPlan flightPlan,
     for (auto flightPlan : m_flightPlans)
     {
         // push new trajectory
-        m_flights.push_back(FlightType(flightPlan, flightParam, step));
+        m_flights.push_back(FlightType(flightPlan, flightParam, step, tolerance, cacheDirectory));
         // estimate timeWindow
         const Time time = m_flights.back().GetTime();
         const Time startTime =
@@ -62,6 +74,7 @@ Planner<FlightParam, FlightType>::Planner(FlightPlan flightPlan,
 
         NS_LOG_LOGIC("Added flight " << flightPlan);
         NS_LOG_LOGIC("TimeWindow: start at " << startTime << " for " << time);
+        NS_LOG_LOGIC("Curve points: " << m_flights.back().GetN());
     }
 
     NS_LOG_LOGIC("Summary TimeWindow: " << m_timeWindows.size());
@@ -120,18 +133,54 @@ Planner<FlightParam, FlightType>::GetTimeWindow(const Time time) const
 {
     NS_LOG_FUNCTION(time);
 
-    for (uint32_t i = 0; i < m_timeWindows.size(); i++)
+    const auto contains = [this, &time](const size_t i) {
+        return i < m_timeWindows.size() && time.Compare(m_timeWindows[i].first) >= 0 &&
+               time.Compare(m_timeWindows[i].second) == -1;
+    };
+
+    if (contains(m_cursor))
+        return m_cursor;
+
+    if (contains(m_cursor + 1))
+        return ++m_cursor;
+
+    // find the first time window ending after the given time
+    const auto i = std::upper_bound(m_timeWindows.begin(),
+                                    m_timeWindows.end(),
+                                    time,
+                                    [](const Time& t, const std::pair<Time, Time>& tw) {
+                                        return t.Compare(tw.second) == -1;
+                                    });
+
+    if (i != m_timeWindows.end())
     {
-        NS_LOG_LOGIC("Checking if " << time << " < " << m_timeWindows[i].second);
-        if (time.Compare(m_timeWindows[i].second) == -1)
-        {
-            return i;
-        }
+        m_cursor = std::distance(m_timeWindows.begin(), i);
+        NS_LOG_LOGIC("Time window found by binary search: " << m_cursor);
+        return m_cursor;
     }
 
     return -1;
 }
 
+template <typename FlightParam, typename FlightType>
+const Time
+Planner<FlightParam, FlightType>::GetNextTimeWindowStart(const Time time) const
+{
+    NS_LOG_FUNCTION(time);
+
+    if (m_timeWindows.empty())
+        return Seconds(0);
+
+    const auto i = std::upper_bound(m_timeWindows.begin(),
+                                    m_timeWindows.end(),
+                                    time,
+                                    [](const Time& t, const std::pair<Time, Time>& tw) {
+                                        return t.Compare(tw.first) == -1;
+                                    });
+
+    return (i != m_timeWindows.end()) ? i->first : m_timeWindows.back().second;
+}
+
 template class Planner<ConstantAccelerationParam, ConstantAccelerationFlight>;
 template class Planner<ParametricSpeedParam, ParametricSpeedFlight>;
 
@@ -22,12 +22,25 @@
 
 #include <ns3/vector.h>
 
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace ns3
 {
 
+/**
+ * \ingroup mobility
+ * \brief When a drone mobility model notifies its CourseChange trace.
+ */
+enum CourseChangeNotificationType
+{
+    ON_QUERY = 0,          // On every position or velocity query at a new time, i.e., legacy
+    ON_SEGMENT_CHANGE = 1, // When the drone starts a new flight or rest segment
+    PERIODIC = 2,          // Every period, if the position or velocity changed
+    ON_DISPLACEMENT = 3    // Every period, if the drone moved farther than a threshold
+};
+
 /**
  * \ingroup mobility
  * \brief Plan trajectories
@@ -36,13 +49,34 @@ template <typename FlightParam, typename FlightType>
 class Planner
 {
   public:
-    Planner() = default;
-    Planner(FlightPlan flightPlan, FlightParam flightParam, float step);
+    Planner();
+    Planner(FlightPlan flightPlan,
+            FlightParam flightParam,
+            float step,
+            double tolerance = 0.0,
+            const std::string& cacheDirectory = "");
     void Update(const Time t) const;
 
     const Vector GetPosition() const;
     const Vector GetVelocity() const;
+    /**
+     * \brief Find the flight whose time window contains a given time.
+     *
+     * Time usually moves forward, hence the last window found and the following one are checked
+     * first. Otherwise, the windows are searched with a binary search.
+     *
+     * \param t the time since the beginning of the flight plan.
+     * \return the index of the flight, or -1 if the flight plan is over.
+     */
     const int32_t GetTimeWindow(const Time t) const;
+    /**
+     * \brief Get the time the drone starts the first flight after a given time.
+     *
+     * \param t the time since the beginning of the flight plan.
+     * \return the start of the flight, or the end of the flight plan if its last flight already
+     *         started.
+     */
+    const Time GetNextTimeWindowStart(const Time t) const;
 
   private:
     mutable Vector m_currentVelocity;
@@ -54,6 +88,7 @@ class Planner
     std::vector<FlightPlan> m_flightPlans;
     std::vector<FlightType> m_flights;
     std::vector<std::pair<Time, Time>> m_timeWindows; /// Time windows for each flight plan
+    mutable size_t m_cursor; /// Index of the last time window found
 };
 
 } // namespace ns3